@@ -0,0 +1,35 @@
+#ifndef _ALLOC_COUNTER_H_
+#define _ALLOC_COUNTER_H_
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts the heap allocations a program makes, for checking that a code
+// path runs without malloc. It replaces the global operator new and delete,
+// so include it from exactly one source file of a program (the one with main).
+
+static std::atomic<long> allocationCounter(0);
+
+inline long allocationCount() { return allocationCounter.load(std::memory_order_relaxed); }
+
+void* operator new(std::size_t size) {
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+// GCC cannot tell that these pair with the operator new above
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+#endif
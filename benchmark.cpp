@@ -0,0 +1,480 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <typeinfo>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "checkers.h"
+#include "cgi_form.h"
+#include "engine.h"
+#include "move_events.h"
+#include "alloc_counter.h"
+
+using namespace std;
+
+// Move-check throughput benchmark.
+// Runs canCapture, valid_move and the stalemate scan over a fixed set of random positions and
+// compares them with the previous bounds-checked, offset-array versions.
+// Checks cgi_form's buffer parsing against the std::string parsing it
+// replaced, on generated request bodies.
+// form parsing, move and move event, make no heap allocations once warmed up.
+// form parsing and move, make no heap allocations once warmed up.
+
+// Kept out of line like the Board members they are measured against
+#define LEGACY_NOINLINE __attribute__((noinline))
+
+namespace legacy {
+
+typedef vector<vector<int> > Grid;
+
+bool isValidPosition(int row, int col) {
+    return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+}
+
+LEGACY_NOINLINE bool canCapture(const Grid& pieces, int row, int col) {
+    if (!isValidPosition(row, col)) return false;
+
+    int currentType = pieces[row][col];
+    if (currentType == Piece::NONE) return false;
+
+    const int directions[4][2] = {{2,2}, {2,-2}, {-2,2}, {-2,-2}};
+    for (const auto& dir : directions) {
+        int newRow = row + dir[0];
+        int newCol = col + dir[1];
+        if (!isValidPosition(newRow, newCol)) continue;
+
+        int midType = pieces[row + dir[0]/2][col + dir[1]/2];
+        if (pieces[newRow][newCol] == Piece::NONE &&
+            ((currentType == Piece::BLACK && midType == Piece::WHITE) ||
+             (currentType == Piece::WHITE && midType == Piece::BLACK))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+LEGACY_NOINLINE bool valid_move(const Grid& pieces, int fromRow, int fromCol, int toRow, int toCol) {
+    if (!isValidPosition(fromRow, fromCol) || !isValidPosition(toRow, toCol)) return false;
+    if (pieces[fromRow][fromCol] == Piece::NONE) return false;
+    if (pieces[toRow][toCol] != Piece::NONE) return false;
+    if (abs(toRow - fromRow) != 1 || abs(toCol - fromCol) != 1) return false;
+    if (pieces[fromRow][fromCol] == Piece::BLACK && toRow <= fromRow) return false;
+    if (pieces[fromRow][fromCol] == Piece::WHITE && toRow >= fromRow) return false;
+    if ((toRow + toCol) % 2 != 0) return false;
+
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            if (pieces[i][j] == pieces[fromRow][fromCol] && canCapture(pieces, i, j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The stalemate scan updateGameState used to run for the side to move
+LEGACY_NOINLINE bool hasValidMoves(const Grid& pieces, int player) {
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            if (pieces[i][j] == player)
+                for (int di = -2; di <= 2; di++)
+                    for (int dj = -2; dj <= 2; dj++)
+                        if (valid_move(pieces, i, j, i + di, j + dj)) return true;
+    return false;
+}
+
+// update_board.cpp's form parsing before it moved to fixed buffers
+string getFormValue(const string& data, const string& key) {
+    string keyStr = key + "=";
+    size_t pos = data.find(keyStr);
+    if (pos == string::npos) return "";
+    
+    pos += keyStr.length();
+    size_t endPos = data.find('&', pos);
+    if (endPos == string::npos) endPos = data.length();
+    
+    string value = data.substr(pos, endPos - pos);
+    // URL decode the value
+    string decoded;
+    for (size_t i = 0; i < value.length(); i++) {
+        if (value[i] == '%' && i + 2 < value.length()) {
+            string hex = value.substr(i + 1, 2);
+            char ch = static_cast<char>(stoi(hex, nullptr, 16));
+            decoded += ch;
+            i += 2;
+        } else if (value[i] == '+') {
+            decoded += ' ';
+        } else {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+string sanitizeInput(const string& input) {
+    string result;
+    for (char c : input) {
+        if (isalnum(c) || c == ',' || c == '-' || c == '_') {
+            result += c;
+        }
+    }
+    if (result.length() > MAX_CONTENT_LENGTH) {
+        throw runtime_error("Input too long");
+    }
+    return result;
+}
+
+} // namespace legacy
+
+struct Position {
+    string state;
+    legacy::Grid grid;
+};
+
+// Random positions with pieces on dark squares only, roughly mid-game density
+static vector<Position> makePositions(int count) {
+    mt19937 rng(2024);
+    uniform_int_distribution<int> roll(0, 9);
+    vector<Position> positions;
+    for (int n = 0; n < count; ++n) {
+        Position p;
+        p.grid.assign(BOARD_SIZE, vector<int>(BOARD_SIZE, Piece::NONE));
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            for (int j = 0; j < BOARD_SIZE; ++j) {
+                if ((i + j) % 2 == 0) {
+                    int r = roll(rng);
+                    p.grid[i][j] = r < 3 ? Piece::BLACK : r < 6 ? Piece::WHITE : Piece::NONE;
+                }
+                if (!p.state.empty()) p.state += ",";
+                p.state += to_string(p.grid[i][j]);
+            }
+        }
+        positions.push_back(p);
+    }
+    return positions;
+}
+
+// Form bodies as a browser sends them, with the kinds of damage a hostile
+// client can add: stray and truncated escapes, signs, spaces, NULs,
+// non-ASCII bytes, repeated and missing fields, huge numbers
+static vector<string> makeFormBodies(const vector<Position>& positions, int count) {
+    static const char* const keys[] = {"fromCol", "fromRow", "toCol", "toRow", "boardAsString", "gameId"};
+    static const char* const damage[] = {"%", "%4", "%41", "%zz", "%2C", "%00", "%-1", "%+f", "%0x", "% 7",
+                                         "%C3%A9", "+", "&", "=", "-", "-1", " 3", "+3", "0x1f",
+                                         "99999999999", "4294967296", "\xff", "a,b", "_"};
+    mt19937 rng(99);
+    auto pick = [&](int n) { return uniform_int_distribution<int>(0, n - 1)(rng); };
+    vector<string> bodies;
+    for (int n = 0; n < count; ++n) {
+        vector<string> fields;
+        for (int k = 0; k < 6; ++k) {
+            string value = k < 4 ? to_string(pick(10) - 1) : k == 4 ? positions[pick(positions.size())].state : "game-" + to_string(n);
+            if (k == 4 && pick(3) == 0) {
+                string escaped;
+                for (char c : value) escaped += c == ',' ? string("%2C") : string(1, c);
+                value = escaped;
+            }
+            for (int d = pick(4) == 0 ? 1 + pick(3) : 0; d > 0; --d) {
+                string bit = damage[pick(sizeof(damage) / sizeof(damage[0]))];
+                value.insert(pick(value.size() + 1), bit);
+            }
+            fields.push_back(string(keys[k]) + "=" + value);
+        }
+        if (pick(5) == 0) shuffle(fields.begin(), fields.end(), rng);
+        if (pick(8) == 0) fields.erase(fields.begin() + pick(fields.size()));
+        if (pick(8) == 0) fields.insert(fields.begin(), "x" + fields[pick(fields.size())]);
+        string body;
+        for (const string& f : fields) body += (body.empty() ? "" : "&") + f;
+        bodies.push_back(body);
+    }
+    return bodies;
+}
+
+// A parse outcome: the value, or the exception's type and message
+template <typename Fn>
+static string outcome(Fn fn) {
+    try {
+        return "value " + fn();
+    } catch (const exception& e) {
+        return string("throws ") + typeid(e).name() + " " + e.what();
+    }
+}
+
+// Each form field of each body, and the numbers read from them, must come
+// out of cgi_form exactly as out of the std::string code it replaced
+static bool checkFormParsing(const vector<Position>& positions) {
+    static const char* const keys[] = {"fromCol", "fromRow", "toCol", "toRow", "boardAsString", "gameId", "missing"};
+    vector<string> bodies = makeFormBodies(positions, 4000);
+    long compared = 0;
+    for (const string& body : bodies) {
+        for (const char* key : keys) {
+            string legacyValue, value;
+            string expected = outcome([&] {
+                legacyValue = legacy::getFormValue(body, key);
+                return legacyValue;
+            });
+            string actual = outcome([&] {
+                char buffer[FORM_BUFFER_SIZE];
+                value.assign(buffer, getFormValue(body.c_str(), key, buffer));
+                return value;
+            });
+            string expectedClean = outcome([&] { return legacy::sanitizeInput(legacyValue); });
+            string actualClean = outcome([&] {
+                char buffer[FORM_BUFFER_SIZE];
+                memcpy(buffer, value.data(), value.size());
+                return string(buffer, sanitizeInput(buffer, value.size()));
+            });
+            string expectedInt = outcome([&] { return to_string(stoi(legacyValue)); });
+            string actualInt = outcome([&] { return to_string(formInt(value.c_str())); });
+            string expectedLong = outcome([&] { return to_string(stoul(legacyValue)); });
+            string actualLong = outcome([&] { return to_string(formUnsignedLong(value.c_str())); });
+            if (expected != actual || expectedClean != actualClean ||
+                expectedInt != actualInt || expectedLong != actualLong) {
+                cerr << "Form parsing mismatch for " << key << " in body [" << body << "]" << endl;
+                return false;
+            }
+            compared++;
+        }
+    }
+    cout << "form parsing: " << compared << " fields of " << bodies.size()
+         << " generated bodies agree with the std::string versions\n";
+    return true;
+}
+
+template <typename Fn>
+static double timeLoop(int iterations, Fn fn) {
+    auto start = chrono::steady_clock::now();
+    for (int it = 0; it < iterations; ++it) fn();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void report(const string& name, long long calls, double legacySecs, double tableSecs) {
+    cout << name << ": " << calls << " calls\n";
+    cout << "  before (offset arrays): " << calls / legacySecs / 1e6 << " M calls/s\n";
+    cout << "  after  (lookup tables): " << calls / tableSecs / 1e6 << " M calls/s"
+         << "  (" << legacySecs / tableSecs << "x)\n";
+}
+
+// Runs op once to warm up, then counts the allocations of `rounds` more runs
+template <typename Fn>
+static bool allocationFree(const string& name, int rounds, Fn op) {
+    op();
+    long before = allocationCount();
+    for (int i = 0; i < rounds; ++i) op();
+    long allocations = allocationCount() - before;
+    cout << "  " << name << ": " << allocations << "\n";
+    return allocations == 0;
+}
+
+// What update_board.cgi does with a move request once the body is read.
+// Returns whether the move event was delivered
+static bool moveRequest(const char* body, Board& board) {
+    char fromRow[FORM_BUFFER_SIZE], fromCol[FORM_BUFFER_SIZE], toRow[FORM_BUFFER_SIZE], toCol[FORM_BUFFER_SIZE];
+    char boardState[FORM_BUFFER_SIZE], gameId[FORM_BUFFER_SIZE];
+    getFormValue(body, "fromRow", fromRow);
+    getFormValue(body, "fromCol", fromCol);
+    getFormValue(body, "toRow", toRow);
+    getFormValue(body, "toCol", toCol);
+    size_t length = sanitizeInput(boardState, getFormValue(body, "boardAsString", boardState));
+    if (!validGameId(gameId, getFormValue(body, "gameId", gameId))) strcpy(gameId, DEFAULT_GAME_ID);
+
+    int from[2] = {formInt(fromRow) - 1, formInt(fromCol)}, to[2] = {formInt(toRow) - 1, formInt(toCol)};
+    board.stringToBoard(boardState, length);
+    board.updateBoard(from[0], from[1], to[0], to[1]);
+    bool published = publishMoveEvent(makeMoveEvent(gameId, board, from[0], from[1], to[0], to[1]));
+    board.printBoard();
+    return published;
+}
+
+static bool checkAllocations(const vector<Position>& positions) {
+    const int rounds = 1000;
+    Board board, copy;
+    string text;
+    SquareMove moves[MAX_MOVES];
+    TranspositionTable tt;
+    atomic<bool> stop(false);
+    atomic<long long> deadline(LLONG_MAX);
+    size_t n = 0;
+    long long sink = 0;
+
+    cout << "heap allocations in " << rounds << " calls after warmup:\n";
+    bool ok = true;
+    ok &= allocationFree("Board construction, reset, initPieces", rounds, [&] {
+        Board fresh;
+        fresh.reset();
+        fresh.initPieces();
+        sink += fresh.pieceAt(0, 0);
+    });
+    ok &= allocationFree("Board copy", rounds, [&] {
+        copy = board;
+        Board local = copy;
+        sink += local.pieceAt(0, 0);
+    });
+    ok &= allocationFree("stringToBoard", rounds, [&] {
+        board.stringToBoard(positions[n++ % positions.size()].state);
+    });
+    ok &= allocationFree("boardToString into a reused string", rounds, [&] {
+        board.boardToString(text);
+        sink += text.size();
+    });
+    ok &= allocationFree("valid_move / canCapture", rounds, [&] {
+        sink += board.valid_move(5, 1, 4, 0) + board.canCapture(2, 2);
+    });
+    ok &= allocationFree("updateGameState", rounds, [&] {
+        board.updateGameState();
+        sink += board.getGameState();
+    });
+    ok &= allocationFree("generateMoves + applyMove", rounds, [&] {
+        copy = board;
+        int count = copy.generateMoves(Piece::WHITE, moves);
+        if (count > 0) copy.applyMove(moves[0]);
+        sink += count;
+    });
+
+    // updateBoard saves game_state.txt and the page goes to stdout: run the
+    // requests in a scratch directory with cout switched off, publishing
+    // their move events to a socket of our own
+    char cwd[4096], scratch[] = "/tmp/checkers-benchmark-XXXXXX";
+    if (!getcwd(cwd, sizeof(cwd)) || !mkdtemp(scratch) || chdir(scratch) != 0) {
+        cerr << "Cannot set up a scratch directory for updateBoard" << endl;
+        return false;
+    }
+    string socketPath = string(scratch) + "/events.sock";
+    struct sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socketPath.c_str());
+    int events = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (events < 0 || ::bind(events, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        cerr << "Cannot bind " << socketPath << endl;
+        return false;
+    }
+    setenv("CHECKERS_EVENT_SOCKET", socketPath.c_str(), 1);
+
+    board.initPieces();
+    // An id too long for the short-string buffer, so a std::string copy would show
+    string body = "fromCol=1&fromRow=6&toCol=0&toRow=5&boardAsString=" + board.boardToString() +
+                  "&currentBoardState=&gameId=benchmark-game-with-a-long-id";
+    Board played;
+    int delivered = 0;
+    char datagram[MAX_EVENT_DATAGRAM];
+    ok &= allocationFree("move request: form parsing, stringToBoard, updateBoard, publish, printBoard", rounds, [&] {
+        streambuf* page = cout.rdbuf(nullptr);
+        bool published = moveRequest(body.c_str(), played);
+        cout.rdbuf(page);
+        cout.clear();
+        delivered += published && recv(events, datagram, sizeof(datagram), 0) > 0;
+        sink += played.pieceAt(4, 0);
+    });
+    if (delivered < rounds) {
+        cerr << "Only " << delivered << " of " << rounds << " move events delivered" << endl;
+        ok = false;
+    }
+    unsetenv("CHECKERS_EVENT_SOCKET");
+    close(events);
+    remove(socketPath.c_str());
+    remove("game_state.txt");
+    if (chdir(cwd) != 0 || rmdir(scratch) != 0) cerr << "Cannot remove " << scratch << endl;
+
+    ok &= allocationFree("engine search, depth 6", 20, [&] {
+        Search search(tt, stop, deadline);
+        sink += search.run(board, Piece::WHITE, 6, [](const SearchResult&) {}).nodes;
+    });
+    cerr << "(allocation checksum " << sink << ")" << endl;
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? stoi(argv[1]) : 200;
+    vector<Position> positions = makePositions(256);
+    vector<Board> boards(positions.size());
+    for (size_t n = 0; n < positions.size(); ++n) {
+        boards[n].stringToBoard(positions[n].state);
+    }
+
+    // Both versions must agree before their speed means anything
+    const int offsets[8][2] = {{1,1}, {1,-1}, {-1,1}, {-1,-1}, {2,2}, {2,-2}, {-2,2}, {-2,-2}};
+    for (size_t n = 0; n < positions.size(); ++n) {
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            for (int j = 0; j < BOARD_SIZE; ++j) {
+                bool ok = (i + j) % 2 != 0 || // light squares hold no pieces
+                          boards[n].canCapture(i, j) == legacy::canCapture(positions[n].grid, i, j);
+                for (const auto& off : offsets) {
+                    ok = ok && boards[n].valid_move(i, j, i + off[0], j + off[1]) ==
+                               legacy::valid_move(positions[n].grid, i, j, i + off[0], j + off[1]);
+                }
+                ok = ok && boards[n].hasValidMoves(Piece::WHITE) == legacy::hasValidMoves(positions[n].grid, Piece::WHITE) &&
+                           boards[n].hasValidMoves(Piece::BLACK) == legacy::hasValidMoves(positions[n].grid, Piece::BLACK);
+                if (!ok) {
+                    cerr << "Mismatch in position " << n << " at " << i << "," << j << endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    if (!checkFormParsing(positions)) return 1;
+
+    long long sink = 0;
+    long long captureCalls = static_cast<long long>(iterations) * positions.size() * BOARD_SIZE * BOARD_SIZE;
+    double legacyCapture = timeLoop(iterations, [&] {
+        for (const auto& p : positions)
+            for (int i = 0; i < BOARD_SIZE; ++i)
+                for (int j = 0; j < BOARD_SIZE; ++j)
+                    sink += legacy::canCapture(p.grid, i, j);
+    });
+    double tableCapture = timeLoop(iterations, [&] {
+        for (const auto& b : boards)
+            for (int i = 0; i < BOARD_SIZE; ++i)
+                for (int j = 0; j < BOARD_SIZE; ++j)
+                    sink += b.canCapture(i, j);
+    });
+
+    long long moveCalls = captureCalls * 8;
+    double legacyMove = timeLoop(iterations, [&] {
+        for (const auto& p : positions)
+            for (int i = 0; i < BOARD_SIZE; ++i)
+                for (int j = 0; j < BOARD_SIZE; ++j)
+                    for (const auto& off : offsets)
+                        sink += legacy::valid_move(p.grid, i, j, i + off[0], j + off[1]);
+    });
+    double tableMove = timeLoop(iterations, [&] {
+        for (const auto& b : boards)
+            for (int i = 0; i < BOARD_SIZE; ++i)
+                for (int j = 0; j < BOARD_SIZE; ++j)
+                    for (const auto& off : offsets)
+                        sink += b.valid_move(i, j, i + off[0], j + off[1]);
+    });
+
+    long long scanCalls = static_cast<long long>(iterations) * positions.size() * 2;
+    double legacyScan = timeLoop(iterations, [&] {
+        for (const auto& p : positions) {
+            sink += legacy::hasValidMoves(p.grid, Piece::WHITE);
+            sink += legacy::hasValidMoves(p.grid, Piece::BLACK);
+        }
+    });
+    double tableScan = timeLoop(iterations, [&] {
+        for (const auto& b : boards) {
+            sink += b.hasValidMoves(Piece::WHITE);
+            sink += b.hasValidMoves(Piece::BLACK);
+        }
+    });
+
+    report("canCapture", captureCalls, legacyCapture, tableCapture);
+    report("valid_move", moveCalls, legacyMove, tableMove);
+    report("stalemate scan", scanCalls, legacyScan, tableScan);
+    cerr << "(checksum " << sink << ")" << endl;
+
+    if (!checkAllocations(positions)) {
+        cerr << "Hot path allocates after warmup" << endl;
+        return 1;
+    }
+    return 0;
+}
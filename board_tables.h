@@ -0,0 +1,72 @@
+#ifndef _BOARD_TABLES_H_
+#define _BOARD_TABLES_H_
+
+// Compile-time lookup tables for the 32 playable (dark) squares.
+// Dark squares are the ones where (row + col) is even, numbered row by row:
+// square = row * 4 + col / 2.
+
+#define NUM_SQUARES 32
+#define NUM_DIRECTIONS 4
+#define NO_SQUARE -1
+
+// Diagonal directions, in the same order canCapture has always scanned them.
+// Black men move towards higher rows (DOWN_*), white men towards lower rows (UP_*).
+enum Direction { DOWN_RIGHT, DOWN_LEFT, UP_RIGHT, UP_LEFT };
+
+struct SquareTables {
+    int row[NUM_SQUARES];
+    int col[NUM_SQUARES];
+    int index[BOARD_SIZE][BOARD_SIZE];             // NO_SQUARE on light squares
+    int neighbour[NUM_SQUARES][NUM_DIRECTIONS];    // one diagonal step, NO_SQUARE if off board
+    int jump[NUM_SQUARES][NUM_DIRECTIONS];         // landing square of a jump, NO_SQUARE if off board
+    int jumped[NUM_SQUARES][NUM_SQUARES];          // square in between a jump, NO_SQUARE if not a jump
+};
+
+constexpr SquareTables buildSquareTables() {
+    SquareTables t{};
+    const int dRow[NUM_DIRECTIONS] = {1, 1, -1, -1};
+    const int dCol[NUM_DIRECTIONS] = {1, -1, 1, -1};
+
+    for (int r = 0; r < BOARD_SIZE; ++r) {
+        for (int c = 0; c < BOARD_SIZE; ++c) {
+            t.index[r][c] = NO_SQUARE;
+        }
+    }
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        int r = sq / 4;
+        int c = (sq % 4) * 2 + (r % 2);
+        t.row[sq] = r;
+        t.col[sq] = c;
+        t.index[r][c] = sq;
+    }
+    for (int from = 0; from < NUM_SQUARES; ++from) {
+        for (int to = 0; to < NUM_SQUARES; ++to) {
+            t.jumped[from][to] = NO_SQUARE;
+        }
+    }
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+            int r1 = t.row[sq] + dRow[d], c1 = t.col[sq] + dCol[d];
+            int r2 = t.row[sq] + 2 * dRow[d], c2 = t.col[sq] + 2 * dCol[d];
+            bool stepOnBoard = r1 >= 0 && r1 < BOARD_SIZE && c1 >= 0 && c1 < BOARD_SIZE;
+            bool jumpOnBoard = r2 >= 0 && r2 < BOARD_SIZE && c2 >= 0 && c2 < BOARD_SIZE;
+            t.neighbour[sq][d] = stepOnBoard ? t.index[r1][c1] : NO_SQUARE;
+            t.jump[sq][d] = jumpOnBoard ? t.index[r2][c2] : NO_SQUARE;
+            if (jumpOnBoard) {
+                t.jumped[sq][t.index[r2][c2]] = t.index[r1][c1];
+            }
+        }
+    }
+    return t;
+}
+
+constexpr SquareTables SQUARE_TABLES = buildSquareTables();
+
+static_assert(SQUARE_TABLES.index[0][0] == 0 && SQUARE_TABLES.index[7][7] == 31,
+              "dark squares must be numbered from the top-left corner");
+static_assert(SQUARE_TABLES.neighbour[0][DOWN_RIGHT] == 4 && SQUARE_TABLES.neighbour[0][UP_RIGHT] == NO_SQUARE,
+              "neighbour table out of step with the board layout");
+static_assert(SQUARE_TABLES.jump[0][DOWN_RIGHT] == 9 && SQUARE_TABLES.jumped[0][9] == 4,
+              "jump table out of step with the board layout");
+
+#endif
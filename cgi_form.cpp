@@ -0,0 +1,99 @@
+#include <iostream>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "cgi_form.h"
+
+using namespace std;
+
+size_t getPostData(char* data) {
+    const char* contentLengthEnv = getenv("CONTENT_LENGTH");
+    if (!contentLengthEnv) {
+        throw runtime_error("No Content-Length header");
+    }
+
+    unsigned long contentLength = formUnsignedLong(contentLengthEnv);
+
+    if (contentLength > MAX_CONTENT_LENGTH) {
+        throw runtime_error("Input exceeds maximum allowed size");
+    }
+
+    // Read exactly the number of bytes specified
+    cin.read(data, contentLength);
+    size_t bytesRead = cin.gcount();
+
+    if (bytesRead != contentLength) {
+        throw runtime_error("Incomplete data read");
+    }
+
+    data[contentLength] = '\0';
+    return strlen(data);
+}
+
+size_t getFormValue(const char* data, const char* key, char* value) {
+    // First "key=" anywhere in the body, as a search for the whole string finds it
+    size_t keyLength = strlen(key);
+    const char* start = strstr(data, key);
+    while (start && start[keyLength] != '=') {
+        start = strstr(start + 1, key);
+    }
+    value[0] = '\0';
+    if (!start) return 0;
+
+    start += keyLength + 1;
+    const char* end = strchr(start, '&');
+    if (!end) end = start + strlen(start);
+
+    // URL decode the value; a '%' in the last two characters is kept as is
+    size_t length = 0;
+    for (const char* p = start; p < end; p++) {
+        if (*p == '%' && p + 2 < end) {
+            char hex[3] = {p[1], p[2], '\0'};
+            char* hexEnd;
+            long ch = strtol(hex, &hexEnd, 16);
+            if (hexEnd == hex) throw invalid_argument("stoi");
+            value[length++] = static_cast<char>(ch);
+            p += 2;
+        } else if (*p == '+') {
+            value[length++] = ' ';
+        } else {
+            value[length++] = *p;
+        }
+    }
+    value[length] = '\0';
+    return length;
+}
+
+size_t sanitizeInput(char* input, size_t length) {
+    size_t kept = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = input[i];
+        if (isalnum(static_cast<unsigned char>(c)) || c == ',' || c == '-' || c == '_') {
+            input[kept++] = c;
+        }
+    }
+    input[kept] = '\0';
+    return kept;
+}
+
+unsigned long formUnsignedLong(const char* value) {
+    // Same checks stoul makes, without building a string for it
+    char* end;
+    errno = 0;
+    unsigned long result = strtoul(value, &end, 10);
+    if (end == value) throw invalid_argument("stoul");
+    if (errno == ERANGE) throw out_of_range("stoul");
+    return result;
+}
+
+int formInt(const char* value) {
+    char* end;
+    errno = 0;
+    long result = strtol(value, &end, 10);
+    if (end == value) throw invalid_argument("stoi");
+    if (errno == ERANGE || result < INT_MIN || result > INT_MAX) throw out_of_range("stoi");
+    return static_cast<int>(result);
+}
@@ -0,0 +1,33 @@
+#ifndef _CGI_FORM_H_
+#define _CGI_FORM_H_
+
+#include <cstddef>
+#include "checkers.h"
+
+using namespace std;
+
+// Form-encoded request parsing for the CGIs. Everything is read and decoded
+// into caller-owned buffers of FORM_BUFFER_SIZE bytes, which hold any value a
+// body of MAX_CONTENT_LENGTH can carry, so parsing a request never touches
+// the heap. Errors are thrown as runtime_error, as the CGIs report them.
+
+#define FORM_BUFFER_SIZE (MAX_CONTENT_LENGTH + 1)
+
+// Reads the CONTENT_LENGTH bytes of the POST body into data, NUL-terminated.
+// Returns its length, cut at any embedded NUL
+size_t getPostData(char* data);
+
+// Decodes the value of key into value, NUL-terminated; empty when key is
+// missing. Returns the decoded length, which may include %00 bytes
+size_t getFormValue(const char* data, const char* key, char* value);
+
+// Keeps only letters, digits, ',', '-' and '_' in place; returns the new length
+size_t sanitizeInput(char* input, size_t length);
+
+// stoi on a form value: leading digits, invalid_argument when there are none
+int formInt(const char* value);
+
+// stoul, as CONTENT_LENGTH was parsed
+unsigned long formUnsignedLong(const char* value);
+
+#endif
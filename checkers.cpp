@@ -4,6 +4,10 @@
 #include <sstream>
 #include <mutex>
 #include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -14,7 +18,6 @@ void Board::updatePieces(int fromRow, int fromCol, int toRow, int toCol) {
 }
 
 void Board::initPieces() {
-    pieces.resize(row, vector<Piece>(column, Piece(Piece::NONE)));
     for (int i = 0; i < 3; ++i) {
         for (int j = 0; j < column; ++j) {
             if (board[i][j] == 0) {
@@ -32,9 +35,21 @@ void Board::initPieces() {
     }
 }
 
+void Board::reset() {
+    for (auto& rowPieces : pieces) {
+        rowPieces.fill(Piece(Piece::NONE));
+    }
+    historyEnd = 0;
+    historySize = 0;
+    currentState = ONGOING;
+    isWhiteTurn = true;
+}
+
 void Board::printBoard() {
 	interface();
-        string currentState = boardToString();
+        char currentState[BOARD_STRING_LENGTH + 1];
+        writeBoard(currentState);
+        currentState[BOARD_STRING_LENGTH] = '\0';
 	cout << "<div id='board' class='table-container' data-board-state='" << currentState << "'>";
     	cout << "<table class='game-board'>\n";
 	//labels the top of the board
@@ -74,7 +89,7 @@ void Board::updateBoard(int fromRow, int fromCol, int toRow, int toCol) {
     }
     
     auto oldState = pieces;
-    bool isCapture = abs(toRow - fromRow) == 2;
+    bool isCapture = jumpedSquare(fromRow, fromCol, toRow, toCol) != NO_SQUARE;
     
     try {
         updatePieces(fromRow, fromCol, toRow, toCol);
@@ -94,72 +109,36 @@ void Board::updateBoard(int fromRow, int fromCol, int toRow, int toCol) {
     }
 }
 
-bool Board::valid_move(int fromRow, int fromCol, int toRow, int toCol) {
-    if (fromRow < 0 || fromRow >= row || fromCol < 0 || fromCol >= column ||
-        toRow < 0 || toRow >= row || toCol < 0 || toCol >= column) {
-        return false;
-    }
-
-    if (pieces[fromRow][fromCol].getType() == Piece::NONE) {
-        return false;
-    }
-
-    if (pieces[toRow][toCol].getType() != Piece::NONE) {
-        return false;
-    }
-
-    if (abs(toRow - fromRow) != 1 || abs(toCol - fromCol) != 1) {
+bool Board::valid_move(int fromRow, int fromCol, int toRow, int toCol) const {
+    if (!isValidPosition(fromRow, fromCol) || !isValidPosition(toRow, toCol)) {
         return false;
     }
 
-    if (pieces[fromRow][fromCol].getType() == Piece::BLACK && toRow <= fromRow){
+    // Pieces only stand on and move to dark squares
+    int fromSq = SQUARE_TABLES.index[fromRow][fromCol];
+    int toSq = SQUARE_TABLES.index[toRow][toCol];
+    if (fromSq == NO_SQUARE || toSq == NO_SQUARE) {
         return false;
     }
 
-    if (pieces[fromRow][fromCol].getType() == Piece::WHITE && toRow >= fromRow) {
+    Piece::Type currentPiece = pieceOn(fromSq);
+    if (currentPiece == Piece::NONE) {
         return false;
     }
 
-    if (board[toRow][toCol] != 0) {
+    // One diagonal step forward: black moves down the board, white moves up
+    int forward = (currentPiece == Piece::BLACK) ? DOWN_RIGHT : UP_RIGHT;
+    if (SQUARE_TABLES.neighbour[fromSq][forward] != toSq &&
+        SQUARE_TABLES.neighbour[fromSq][forward + 1] != toSq) {
         return false;
     }
 
-    int rowDiff = abs(toRow - fromRow);
-    int colDiff = abs(toCol - fromCol);
-    
-    if (rowDiff == 2 && colDiff == 2) {
-        int midRow = (fromRow + toRow) / 2;
-        int midCol = (fromCol + toCol) / 2;
-        Piece::Type midPiece = pieces[midRow][midCol].getType();
-        Piece::Type currentPiece = pieces[fromRow][fromCol].getType();
-        
-        if ((currentPiece == Piece::BLACK && midPiece == Piece::WHITE) ||
-            (currentPiece == Piece::WHITE && midPiece == Piece::BLACK)) {
-            pieces[midRow][midCol].setType(Piece::NONE);
-            return true;
-        }
+    if (pieceOn(toSq) != Piece::NONE) {
         return false;
     }
 
-    // Check for mandatory captures
-    bool hasCapture = false;
-    for (int i = 0; i < row; i++) {
-        for (int j = 0; j < column; j++) {
-            if (pieces[i][j].getType() == pieces[fromRow][fromCol].getType() &&
-                canCapture(i, j)) {
-                hasCapture = true;
-                break;
-            }
-        }
-        if (hasCapture) break;
-    }
-
     // If there's a capture available, only allow capture moves
-    if (hasCapture && abs(toRow - fromRow) != 2) {
-        return false;
-    }
-
-    return (rowDiff == 1 && colDiff == 1);
+    return !sideCanCapture(currentPiece);
 }
 
 
@@ -171,75 +150,75 @@ void Board::make_move(int fromRow, int fromCol, int toRow, int toCol) {
 
 string Board::boardToString() const {
     string result;
+    boardToString(result);
+    return result;
+}
+
+void Board::boardToString(string& out) const {
+    char text[BOARD_STRING_LENGTH];
+    writeBoard(text);
+    out.assign(text, BOARD_STRING_LENGTH);
+}
+
+void Board::writeBoard(char* out) const {
     for (int i = 0; i < row; ++i) {
         for (int j = 0; j < column; ++j) {
-            if (!result.empty()) result += ",";
-            if (pieces[i][j].getType() == Piece::NONE) result += "0";
-            else if (pieces[i][j].getType() == Piece::BLACK) result += "1";
-            else if (pieces[i][j].getType() == Piece::WHITE) result += "2";
+            if (i > 0 || j > 0) *out++ = ',';
+            *out++ = static_cast<char>('0' + pieces[i][j].getType());
         }
     }
-    return result;
 }
 
 void Board::stringToBoard(const string& boardState) {
-    if (boardState.empty()) {
+    stringToBoard(boardState.data(), boardState.size());
+}
+
+void Board::stringToBoard(const char* boardState, size_t length) {
+    if (length == 0) {
         throw runtime_error("Empty board state");
     }
 
-    // Create temporary board for validation
-    vector<vector<Piece>> tempPieces(row, vector<Piece>(column, Piece(Piece::NONE)));
-    
-    istringstream ss(boardState);
-    string token;
-    int r = 0, c = 0;
-    
-    // Collect all tokens first
-    vector<string> tokens;
-    while (getline(ss, token, ',')) {
-        tokens.push_back(token);
-    }
-    
-    // Use static_cast to compare sizes safely
-    if (tokens.size() != static_cast<size_t>(row * column)) {
+    // Comma-separated tokens; a trailing comma does not start another one
+    size_t tokens = count(boardState, boardState + length, ',') + 1;
+    if (boardState[length - 1] == ',') tokens--;
+    if (tokens != static_cast<size_t>(row * column)) {
         throw runtime_error("Board state data does not match board dimensions");
     }
-    
-    // Reset stream
-    ss.clear();
-    ss.str(boardState);
-    
-    // Reset counters
-    r = 0;
-    c = 0;
-    
-    while (getline(ss, token, ',')) {
-        if (r >= row || c >= column) {
-            throw runtime_error("Board state data exceeds board dimensions");
-        }
-        
-        try {
-            int value = stoi(token);
+
+    // Parse into a temporary board so a bad token leaves this one untouched
+    PieceGrid tempPieces;
+    size_t pos = 0;
+    for (int r = 0; r < row; ++r) {
+        for (int c = 0; c < column; ++c) {
+            const char* comma = static_cast<const char*>(memchr(boardState + pos, ',', length - pos));
+            size_t end = comma ? comma - boardState : length;
+
+            // Leading sign and digits, the rest ignored, as stoi reads a token
+            size_t i = pos;
+            while (i < end && isspace(static_cast<unsigned char>(boardState[i]))) i++;
+            bool negative = i < end && boardState[i] == '-';
+            if (i < end && (boardState[i] == '-' || boardState[i] == '+')) i++;
+            if (i == end || !isdigit(static_cast<unsigned char>(boardState[i]))) {
+                throw runtime_error("Invalid data format in board state");
+            }
+            long value = 0;
+            while (i < end && isdigit(static_cast<unsigned char>(boardState[i])) && value <= 2) {
+                value = value * 10 + (boardState[i++] - '0');
+            }
+            if (negative) value = -value;
             if (value < 0 || value > 2) {
                 throw runtime_error("Invalid piece value in board state");
             }
             tempPieces[r][c] = Piece(static_cast<Piece::Type>(value));
-        } catch (const invalid_argument&) {
-            throw runtime_error("Invalid data format in board state");
-        }
-        
-        c++;
-        if (c >= column) {
-            c = 0;
-            r++;
+            pos = end + 1;
         }
     }
-    
+
     // Only update actual board after validation succeeds
     pieces = tempPieces;
 }
 
-bool Board::checkmate() {
+bool Board::checkmate() const {
     bool foundWhite = false;
     bool foundBlack = false;
     
@@ -306,24 +285,33 @@ void Board::interface() {
 
 bool Board::canCapture(int row, int col) const {
     if (!isValidPosition(row, col)) return false;
-    
-    Piece::Type currentType = pieces[row][col].getType();
+
+    int square = SQUARE_TABLES.index[row][col];
+    if (square == NO_SQUARE) return false;
+
+    return canCaptureFrom(square);
+}
+
+bool Board::canCaptureFrom(int square) const {
+    Piece::Type currentType = pieceOn(square);
     if (currentType == Piece::NONE) return false;
-    
-    // Check all possible capture directions
-    const int directions[4][2] = {{2,2}, {2,-2}, {-2,2}, {-2,-2}};
-    for (const auto& dir : directions) {
-        int newRow = row + dir[0];
-        int newCol = col + dir[1];
-        if (!isValidPosition(newRow, newCol)) continue;
-        
-        int midRow = row + dir[0]/2;
-        int midCol = col + dir[1]/2;
-        Piece::Type midType = pieces[midRow][midCol].getType();
-        
-        if (pieces[newRow][newCol].getType() == Piece::NONE &&
-            ((currentType == Piece::BLACK && midType == Piece::WHITE) ||
-             (currentType == Piece::WHITE && midType == Piece::BLACK))) {
+
+    Piece::Type opponent = (currentType == Piece::BLACK) ? Piece::WHITE : Piece::BLACK;
+    for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+        int landing = SQUARE_TABLES.jump[square][d];
+        if (landing == NO_SQUARE) continue;
+
+        if (pieceOn(SQUARE_TABLES.neighbour[square][d]) == opponent &&
+            pieceOn(landing) == Piece::NONE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Board::sideCanCapture(Piece::Type side) const {
+    for (int square = 0; square < NUM_SQUARES; ++square) {
+        if (pieceOn(square) == side && canCaptureFrom(square)) {
             return true;
         }
     }
@@ -349,26 +337,8 @@ void Board::updateGameState() {
     }
     
     // Check for stalemate (no valid moves available)
-    bool hasValidMoves = false;
     Piece::Type currentPlayer = isWhiteTurn ? Piece::WHITE : Piece::BLACK;
-    
-    for (int i = 0; i < row && !hasValidMoves; ++i) {
-        for (int j = 0; j < column && !hasValidMoves; ++j) {
-            if (pieces[i][j].getType() == currentPlayer) {
-                // Check all possible moves
-                for (int di = -2; di <= 2; di++) {
-                    for (int dj = -2; dj <= 2; dj++) {
-                        if (valid_move(i, j, i + di, j + dj)) {
-                            hasValidMoves = true;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    if (!hasValidMoves) {
+    if (!hasValidMoves(currentPlayer)) {
         currentState = DRAW;
         return;
     }
@@ -376,15 +346,61 @@ void Board::updateGameState() {
     currentState = ONGOING;
 }
 
+bool Board::hasValidMoves(Piece::Type player) const {
+    // Same rules as valid_move: an available capture blocks every other move
+    if (sideCanCapture(player)) return false;
+
+    int forward = (player == Piece::BLACK) ? DOWN_RIGHT : UP_RIGHT;
+    for (int square = 0; square < NUM_SQUARES; ++square) {
+        if (pieceOn(square) != player) continue;
+
+        for (int d = forward; d <= forward + 1; ++d) {
+            int step = SQUARE_TABLES.neighbour[square][d];
+            if (step != NO_SQUARE && pieceOn(step) == Piece::NONE) return true;
+        }
+    }
+    return false;
+}
+
+int Board::generateMoves(Piece::Type player, SquareMove* moves) const {
+    // Same rules as valid_move: an available capture blocks every other move
+    if (sideCanCapture(player)) return 0;
+
+    int forward = (player == Piece::BLACK) ? DOWN_RIGHT : UP_RIGHT;
+    int count = 0;
+    for (int square = 0; square < NUM_SQUARES; ++square) {
+        if (pieceOn(square) != player) continue;
+
+        for (int d = forward; d <= forward + 1; ++d) {
+            int step = SQUARE_TABLES.neighbour[square][d];
+            if (step != NO_SQUARE && pieceOn(step) == Piece::NONE) {
+                moves[count++] = {square, step};
+            }
+        }
+    }
+    return count;
+}
+
+void Board::applyMove(const SquareMove& move) {
+    int fromRow = SQUARE_TABLES.row[move.from], fromCol = SQUARE_TABLES.col[move.from];
+    int toRow = SQUARE_TABLES.row[move.to], toCol = SQUARE_TABLES.col[move.to];
+    updatePieces(fromRow, fromCol, toRow, toCol);
+    removeCapturedPiece(fromRow, fromCol, toRow, toCol);
+}
+
 void Board::recordMove(int fromRow, int fromCol, int toRow, int toCol, bool wasCapture) {
-    moveHistory.push_back({fromRow, fromCol, toRow, toCol, wasCapture});
+    moveHistory[historyEnd] = {static_cast<int8_t>(fromRow), static_cast<int8_t>(fromCol),
+                               static_cast<int8_t>(toRow), static_cast<int8_t>(toCol), wasCapture};
+    historyEnd = (historyEnd + 1) % MAX_UNDO;
+    historySize = min(historySize + 1, MAX_UNDO);
 }
 
 bool Board::undoLastMove() {
-    if (moveHistory.empty()) return false;
+    if (historySize == 0) return false;
     
-    Move lastMove = moveHistory.back();
-    moveHistory.pop_back();
+    historyEnd = (historyEnd + MAX_UNDO - 1) % MAX_UNDO;
+    historySize--;
+    Move lastMove = moveHistory[historyEnd];
     
     // Restore pieces to their original positions
     pieces[lastMove.fromRow][lastMove.fromCol] = pieces[lastMove.toRow][lastMove.toCol];
@@ -392,9 +408,8 @@ bool Board::undoLastMove() {
     
     if (lastMove.wasCapture) {
         // Restore captured piece
-        int midRow = (lastMove.fromRow + lastMove.toRow) / 2;
-        int midCol = (lastMove.fromCol + lastMove.toCol) / 2;
-        pieces[midRow][midCol] = Piece(
+        int between = jumpedSquare(lastMove.fromRow, lastMove.fromCol, lastMove.toRow, lastMove.toCol);
+        pieces[SQUARE_TABLES.row[between]][SQUARE_TABLES.col[between]] = Piece(
             pieces[lastMove.fromRow][lastMove.fromCol].getType() == Piece::BLACK ? 
             Piece::WHITE : Piece::BLACK
         );
@@ -404,48 +419,60 @@ bool Board::undoLastMove() {
 }
 
 void Board::removeCapturedPiece(int fromRow, int fromCol, int toRow, int toCol) {
-    int midRow = (fromRow + toRow) / 2;
-    int midCol = (fromCol + toCol) / 2;
-    pieces[midRow][midCol].setType(Piece::NONE);
+    int between = jumpedSquare(fromRow, fromCol, toRow, toCol);
+    if (between == NO_SQUARE) return;
+    pieces[SQUARE_TABLES.row[between]][SQUARE_TABLES.col[between]].setType(Piece::NONE);
+}
+
+int Board::jumpedSquare(int fromRow, int fromCol, int toRow, int toCol) const {
+    if (!isValidPosition(fromRow, fromCol) || !isValidPosition(toRow, toCol)) return NO_SQUARE;
+
+    int fromSq = SQUARE_TABLES.index[fromRow][fromCol];
+    int toSq = SQUARE_TABLES.index[toRow][toCol];
+    if (fromSq == NO_SQUARE || toSq == NO_SQUARE) return NO_SQUARE;
+
+    return SQUARE_TABLES.jumped[fromSq][toSq];
 }
 
 void Board::saveState() const {
-    const std::string filename = "game_state.txt";
-    const std::string tempFile = filename + ".tmp";
+    const char* filename = "game_state.txt";
+    const char* tempFile = "game_state.txt.tmp";
 
+    // Plain file descriptors and a fixed-size line, so saving allocates nothing
     try {
         // Validate directory permissions with test write
-        std::ofstream testWrite("test_write_permission.tmp");
-        if (!testWrite) {
+        int testWrite = open("test_write_permission.tmp", O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (testWrite < 0) {
             throw std::runtime_error("Cannot write to current directory. Check permissions.");
         }
-        testWrite.close();
+        close(testWrite);
         std::remove("test_write_permission.tmp");
 
         // Open the temporary file for writing
-        std::ofstream file(tempFile, std::ios::out | std::ios::binary);
-        if (!file) {
+        int file = open(tempFile, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (file < 0) {
             throw std::runtime_error("Unable to create temporary file: " + std::string(std::strerror(errno)));
         }
 
         // Write the board state
-        std::string boardStateToSave = boardToString();
-        file << boardStateToSave << std::endl;
+        char line[BOARD_STRING_LENGTH + 1];
+        writeBoard(line);
+        line[BOARD_STRING_LENGTH] = '\n';
+        bool written = write(file, line, sizeof(line)) == static_cast<ssize_t>(sizeof(line));
 
         // Check if the data was written successfully
-        if (!file.good()) {
+        if (close(file) != 0 || !written) {
             throw std::runtime_error("Error writing to temporary file");
         }
-        file.close();
 
         // Rename temporary file to final file atomically
-        if (std::rename(tempFile.c_str(), filename.c_str()) != 0) {
+        if (std::rename(tempFile, filename) != 0) {
             throw std::runtime_error("Error renaming temporary file: " + std::string(std::strerror(errno)));
         }
     } catch (const std::exception& e) {
         // Ensure cleanup of temporary files
         std::cerr << "Error saving game state: " << e.what() << std::endl;
-        std::remove(tempFile.c_str());
+        std::remove(tempFile);
         throw;
     }
 }
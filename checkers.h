@@ -2,6 +2,9 @@
 #define _CHECKERS_H_
 
 #include <iostream>
+#include <array>
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <fstream>
 #include <algorithm>
@@ -15,10 +18,21 @@ using namespace std;
 // Add these constants
 #define MAX_CONTENT_LENGTH 4096
 #define BOARD_SIZE 8
+#define MAX_MOVES 64  // two forward steps for each of at most 32 pieces
+#define MAX_UNDO 16   // moves kept for undoLastMove
+#define BOARD_STRING_LENGTH (2 * BOARD_SIZE * BOARD_SIZE - 1)  // "0,1,2,..." without a terminator
+
+#include "board_tables.h"
 
 // Add before the Board class
 enum GameState { ONGOING, WHITE_WIN, BLACK_WIN, DRAW };
 
+// A move between two dark squares, numbered as in board_tables.h
+struct SquareMove {
+    int from;
+    int to;
+};
+
 class Piece{
 	public:
         enum Type { NONE, BLACK, WHITE };
@@ -30,27 +44,38 @@ class Piece{
         };
 
 
+// Fixed-size grids, so a Board (and every copy of it) lives without the heap
+typedef array<array<int, BOARD_SIZE>, BOARD_SIZE> SquareGrid;
+typedef array<array<Piece, BOARD_SIZE>, BOARD_SIZE> PieceGrid;
+
 class Board{
     	private:
-    	vector<vector<int> > board;
-	vector<vector<Piece>> pieces;
+    	SquareGrid board;
+	PieceGrid pieces;
     	int row;
     	int column;
 	void updatePieces(int fromRow, int fromCol, int toRow, int toCol);
+	Piece::Type pieceOn(int square) const {
+		return pieces[SQUARE_TABLES.row[square]][SQUARE_TABLES.col[square]].getType();
+	}
+	bool canCaptureFrom(int square) const;
+	int jumpedSquare(int fromRow, int fromCol, int toRow, int toCol) const; //NO_SQUARE unless a jump
+	void writeBoard(char* out) const; //BOARD_STRING_LENGTH chars, no terminator
 
 	struct Move {
-		int fromRow, fromCol, toRow, toCol;
+		int8_t fromRow, fromCol, toRow, toCol;
 		bool wasCapture;
 	};
-	vector<Move> moveHistory;
+	// The last MAX_UNDO moves, oldest overwritten first
+	array<Move, MAX_UNDO> moveHistory;
+	int historyEnd = 0;
+	int historySize = 0;
 
 	GameState currentState = ONGOING;  // Add this member
 	bool isWhiteTurn = true;  // Add this member
 
 	public:
     	Board() : row(BOARD_SIZE), column(BOARD_SIZE), currentState(ONGOING), isWhiteTurn(true) {
-            board.resize(row, vector<int>(column, 0));  // Initialize with zeros
-            pieces.resize(row, vector<Piece>(column, Piece(Piece::NONE)));
             for (int i = 0; i < row; ++i) {
                 for (int j = 0; j < column; ++j) {
                     board[i][j] = (i + j) % 2;  // Set checkerboard pattern
@@ -58,29 +83,37 @@ class Board{
             }
         }
 	void initPieces();
+	void reset(); //empty board, ready for reuse
     	void printBoard();
     	void start(); //starts up the positions of the checkers objects.
-    	bool valid_move(int fromRow, int fromCol, int toRow, int toCol); //checks if the move is valid
+    	bool valid_move(int fromRow, int fromCol, int toRow, int toCol) const; //checks if the move is valid
     	void make_move(int fromRow, int fromCol, int toRow, int toCol);  //makes the move
 	void updateBoard(int fromRow, int fromCol, int toRow, int toCol);
 	bool loadState();
 	void saveState() const;
 	void stringToBoard(const string& boardState);//for hidden html
+	void stringToBoard(const char* boardState, size_t length);
 	string boardToString() const; //for hidden html
+	void boardToString(string& out) const; //same, reusing out's capacity
 
-	bool checkmate();
+	bool checkmate() const;
 	void interface();
 
     bool isValidPosition(int row, int col) const {
         return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
     }
     
+    Piece::Type pieceAt(int row, int col) const { return pieces[row][col].getType(); }
     bool canCapture(int row, int col) const;
+    bool sideCanCapture(Piece::Type side) const; //true if any piece of this side has a jump
     void removeCapturedPiece(int fromRow, int fromCol, int toRow, int toCol);
 
     bool isGameOver() const { return currentState != ONGOING; }
     GameState getGameState() const { return currentState; }
     void updateGameState();
+    bool hasValidMoves(Piece::Type player) const; //false means stalemate for that side
+    int generateMoves(Piece::Type player, SquareMove* moves) const; //fills up to MAX_MOVES, returns count
+    void applyMove(const SquareMove& move); //moves and captures without history, turn or saving
 
 	void recordMove(int fromRow, int fromCol, int toRow, int toCol, bool wasCapture);
 	bool undoLastMove();
@@ -1,5 +1,8 @@
 console.log("JavaScript loaded");
 
+// Move events are pushed by event_server, mounted by the web server at this path
+const EVENTS_URL = 'events';
+
 // Function to load the board initially
 function loadBoard() {
     fetch('checkers.cgi')
@@ -107,6 +110,62 @@ function submitMove(event) {
     });
 }
 
+// Game to play and watch, from the page's ?game= parameter
+function currentGameId() {
+    const id = new URLSearchParams(window.location.search).get('game');
+    return id && /^[A-Za-z0-9_-]{1,64}$/.test(id) ? id : 'default';
+}
+
+// Function to apply a pushed move to the rendered board and hidden state
+function applyMoveDelta(delta) {
+    const table = document.querySelector('#board table');
+    if (!table) return;
+
+    // Row 0 of the table holds the column labels
+    const cell = (pos) => table.rows[pos[0] + 1]?.cells[pos[1]];
+    const from = cell(delta.from);
+    const to = cell(delta.to);
+    const piece = from?.querySelector('img');
+
+    // Our own moves are already on the board by the time their event arrives
+    if (piece && to && !to.querySelector('img')) {
+        to.appendChild(piece);
+        if (delta.captured) cell(delta.captured).innerHTML = '';
+
+        const state = document.getElementById('currentBoardState').value.split(',');
+        if (state.length === 64) {
+            const index = (pos) => pos[0] * 8 + pos[1];
+            state[index(delta.to)] = state[index(delta.from)];
+            state[index(delta.from)] = '0';
+            if (delta.captured) state[index(delta.captured)] = '0';
+            document.getElementById('boardAsString').value = state.join(',');
+            document.getElementById('currentBoardState').value = state.join(',');
+        }
+    }
+
+    updateTurnIndicator(delta.turn === 'white');
+    if (delta.state !== 'ongoing') {
+        document.getElementById('message').innerHTML =
+            `<div class="success">Game over: ${delta.state.replace('_', ' ')}</div>`;
+    }
+}
+
+// Function to listen for moves instead of polling for them
+function subscribeToMoves() {
+    if (!window.EventSource) return;
+
+    const events = new EventSource(`${EVENTS_URL}?game=${encodeURIComponent(currentGameId())}`);
+    events.addEventListener('move', (event) => {
+        try {
+            applyMoveDelta(JSON.parse(event.data));
+        } catch (error) {
+            console.error('Bad move event:', error);
+        }
+    });
+    // EventSource reconnects by itself, resuming from the last event id
+    events.onerror = () => console.log('Move events disconnected, retrying');
+}
+
 // Function to update the turn indicator
 function updateTurnIndicator(isWhiteTurn) {
     const turnIndicator = document.getElementById('turnIndicator');
@@ -115,5 +174,9 @@ function updateTurnIndicator(isWhiteTurn) {
 }
 
 // Initialize board on page load
-window.onload = loadBoard;
+window.onload = () => {
+    document.getElementById('gameId').value = currentGameId();
+    loadBoard();
+    subscribeToMoves();
+};
 
@@ -0,0 +1,328 @@
+#include <climits>
+#include "engine.h"
+
+using namespace std;
+
+// Zobrist keys, generated at compile time with splitmix64
+struct ZobristKeys {
+    uint64_t piece[NUM_SQUARES][3];  // indexed by Piece::Type, NONE entries stay zero
+    uint64_t blackToMove;
+};
+
+constexpr uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys buildZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x436865636B657273ULL;
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        keys.piece[sq][Piece::BLACK] = splitmix64(state);
+        keys.piece[sq][Piece::WHITE] = splitmix64(state);
+    }
+    keys.blackToMove = splitmix64(state);
+    return keys;
+}
+
+constexpr ZobristKeys ZOBRIST = buildZobristKeys();
+
+static long long nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(EngineClock::now().time_since_epoch()).count();
+}
+
+static long long msSince(EngineClock::time_point start) {
+    return chrono::duration_cast<chrono::milliseconds>(EngineClock::now() - start).count();
+}
+
+static Piece::Type pieceOnSquare(const Board& board, int square) {
+    return board.pieceAt(SQUARE_TABLES.row[square], SQUARE_TABLES.col[square]);
+}
+
+static Piece::Type other(Piece::Type side) {
+    return side == Piece::WHITE ? Piece::BLACK : Piece::WHITE;
+}
+
+uint64_t hashPosition(const Board& board, Piece::Type toMove) {
+    uint64_t key = toMove == Piece::BLACK ? ZOBRIST.blackToMove : 0;
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        key ^= ZOBRIST.piece[sq][pieceOnSquare(board, sq)];
+    }
+    return key;
+}
+
+// Key of the position after move, computed from the key before it
+static uint64_t hashAfter(const Board& board, uint64_t key, const SquareMove& move) {
+    Piece::Type mover = pieceOnSquare(board, move.from);
+    key ^= ZOBRIST.piece[move.from][mover] ^ ZOBRIST.piece[move.to][mover] ^ ZOBRIST.blackToMove;
+    int between = SQUARE_TABLES.jumped[move.from][move.to];
+    if (between != NO_SQUARE) {
+        key ^= ZOBRIST.piece[between][pieceOnSquare(board, between)];
+    }
+    return key;
+}
+
+// Material plus how far the men have advanced, from toMove's point of view
+static int evaluate(const Board& board, Piece::Type toMove) {
+    int score = 0;
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        Piece::Type type = pieceOnSquare(board, sq);
+        if (type == Piece::NONE) continue;
+
+        int advanced = type == Piece::BLACK ? SQUARE_TABLES.row[sq] : BOARD_SIZE - 1 - SQUARE_TABLES.row[sq];
+        int value = 100 + 2 * advanced;
+        score += type == toMove ? value : -value;
+    }
+    return score;
+}
+
+static bool hasPieces(const Board& board, Piece::Type side) {
+    for (int sq = 0; sq < NUM_SQUARES; ++sq) {
+        if (pieceOnSquare(board, sq) == side) return true;
+    }
+    return false;
+}
+
+long TimeManager::budgetMs() const {
+    int movesLeft = max(expectedMoves - movesPlayed, 10);
+    long budget = remainingMs / movesLeft + incrementMs * 3 / 4;
+    return max(1L, min(budget, remainingMs / 2));
+}
+
+void TimeManager::moveMade(long elapsedMs) {
+    remainingMs = max(0L, remainingMs - elapsedMs) + incrementMs;
+    movesPlayed++;
+}
+
+TTEntry* TranspositionTable::probe(uint64_t key) {
+    TTEntry& entry = table[key % table.size()];
+    return entry.key == key ? &entry : nullptr;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, BoundType bound, const SquareMove& best, bool solved) {
+    TTEntry& entry = table[key % table.size()];
+    entry.key = key;
+    entry.score = score;
+    entry.depth = static_cast<int8_t>(depth);
+    entry.bound = static_cast<int8_t>(bound);
+    entry.from = static_cast<int8_t>(best.from);
+    entry.to = static_cast<int8_t>(best.to);
+    entry.solved = solved;
+}
+
+bool Search::timeUp() {
+    if (stop.load(memory_order_relaxed)) return true;
+    // The first iteration always finishes so there is a move to play
+    return iterationDepth > 1 && nowNs() >= deadline.load(memory_order_relaxed);
+}
+
+// Puts the table's best move, if it is among moves, at the front
+static void orderMoves(SquareMove* moves, int count, const TTEntry* entry) {
+    if (!entry || entry->from == NO_SQUARE) return;
+    for (int i = 0; i < count; ++i) {
+        if (moves[i].from == entry->from && moves[i].to == entry->to) {
+            swap(moves[0], moves[i]);
+            return;
+        }
+    }
+}
+
+int Search::alphaBeta(const Board& board, uint64_t key, Piece::Type toMove, int depth, int ply, int alpha, int beta) {
+    if ((++nodes & 1023) == 0 && timeUp()) aborted = true;
+    if (aborted) return 0;
+
+    SquareMove moves[MAX_MOVES];
+    int count = board.generateMoves(toMove, moves);
+    if (count == 0) {
+        // Out of pieces loses; stuck with pieces left is a draw, as in updateGameState
+        return hasPieces(board, toMove) ? 0 : -WIN_SCORE + ply;
+    }
+    if (depth == 0) {
+        horizonReached = true;
+        return evaluate(board, toMove);
+    }
+
+    // A cutoff skips the subtree, so whether it reached the horizon has to
+    // come from the entry; otherwise a warm table would end deepening early
+    TTEntry* entry = tt.probe(key);
+    if (entry && entry->depth >= depth &&
+        (entry->bound == EXACT ||
+         (entry->bound == LOWER_BOUND && entry->score >= beta) ||
+         (entry->bound == UPPER_BOUND && entry->score <= alpha))) {
+        if (!entry->solved) horizonReached = true;
+        return entry->score;
+    }
+    orderMoves(moves, count, entry);
+
+    // Tracked per subtree, for the entry stored below
+    bool outerHorizon = horizonReached;
+    horizonReached = false;
+    int originalAlpha = alpha;
+    int bestScore = -INT_MAX;
+    SquareMove best = moves[0];
+    for (int i = 0; i < count; ++i) {
+        Board child = board;
+        uint64_t childKey = hashAfter(board, key, moves[i]);
+        child.applyMove(moves[i]);
+        int score = -alphaBeta(child, childKey, other(toMove), depth - 1, ply + 1, -beta, -alpha);
+        if (aborted) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            best = moves[i];
+        }
+        alpha = max(alpha, score);
+        if (alpha >= beta) break;
+    }
+
+    BoundType bound = bestScore <= originalAlpha ? UPPER_BOUND : bestScore >= beta ? LOWER_BOUND : EXACT;
+    tt.store(key, depth, bestScore, bound, best, !horizonReached);
+    horizonReached = horizonReached || outerHorizon;
+    return bestScore;
+}
+
+SearchResult Search::iterate(const Board& root, Piece::Type toMove, int depth) {
+    SearchResult result;
+    result.depth = depth;
+
+    SquareMove moves[MAX_MOVES];
+    int count = root.generateMoves(toMove, moves);
+    uint64_t key = hashPosition(root, toMove);
+    orderMoves(moves, count, tt.probe(key));
+
+    int alpha = -INT_MAX;
+    for (int i = 0; i < count; ++i) {
+        Board child = root;
+        uint64_t childKey = hashAfter(root, key, moves[i]);
+        child.applyMove(moves[i]);
+        int score = -alphaBeta(child, childKey, other(toMove), depth - 1, 1, -INT_MAX, -alpha);
+        if (aborted) return result;
+
+        if (score > alpha) {
+            alpha = score;
+            result.best = moves[i];
+        }
+    }
+    result.score = alpha;
+    if (result.best.from != NO_SQUARE) {
+        tt.store(key, depth, alpha, EXACT, result.best, !horizonReached);
+    }
+    return result;
+}
+
+SearchResult Search::run(const Board& root, Piece::Type toMove, int maxDepth,
+                         const function<void(const SearchResult&)>& onDepth) {
+    SearchResult best;
+    SquareMove moves[MAX_MOVES];
+    if (root.generateMoves(toMove, moves) == 0) return best;
+
+    for (iterationDepth = 1; iterationDepth <= maxDepth; ++iterationDepth) {
+        horizonReached = false;
+        SearchResult result = iterate(root, toMove, iterationDepth);
+        if (aborted) break;
+
+        result.nodes = nodes;
+        best = result;
+        onDepth(best);
+
+        // Nothing left to gain from searching deeper
+        if (!horizonReached || abs(best.score) >= WIN_SCORE - MAX_SEARCH_DEPTH) break;
+    }
+    best.nodes = nodes;
+    return best;
+}
+
+void SearchService::start(const Board& position, long long deadlineNs) {
+    stop = false;
+    deadline = deadlineNs;
+    {
+        lock_guard<mutex> lock(resultMutex);
+        result = SearchResult();
+        finished = false;
+    }
+    worker = thread([this, position] {
+        Search search(tt, stop, deadline);
+        search.run(position, engineSide, MAX_SEARCH_DEPTH, [this](const SearchResult& r) {
+            lock_guard<mutex> lock(resultMutex);
+            result = r;
+        });
+        lock_guard<mutex> lock(resultMutex);
+        finished = true;
+        resultReady.notify_all();
+    });
+}
+
+SearchResult SearchService::wait() {
+    SearchResult best;
+    {
+        unique_lock<mutex> lock(resultMutex);
+        resultReady.wait(lock, [this] { return finished; });
+        best = result;
+    }
+    worker.join();
+    return best;
+}
+
+void SearchService::cancel() {
+    if (worker.joinable()) {
+        stop = true;
+        worker.join();
+    }
+    pondering = false;
+}
+
+SquareMove SearchService::think(const Board& position) {
+    auto arrived = EngineClock::now();
+    long budget = clock.budgetMs();
+
+    ponderHit = pondering && hashPosition(position, engineSide) == ponderKey;
+    if (ponderHit) {
+        // Keep the running search, crediting the time it already spent
+        long left = max(0L, budget - static_cast<long>(msSince(ponderStart)));
+        deadline = nowNs() + left * 1000000LL;
+        pondering = false;
+    } else {
+        cancel();
+        start(position, nowNs() + budget * 1000000LL);
+    }
+
+    SearchResult best = wait();
+    clock.moveMade(msSince(arrived));
+    return best.best;
+}
+
+// The opponent's expected reply: the table's best move if the last search
+// left one for this position, otherwise a short search of our own
+SquareMove SearchService::predictReply(const Board& position) {
+    SquareMove moves[MAX_MOVES];
+    int count = position.generateMoves(opponent(), moves);
+    if (count == 0) return {NO_SQUARE, NO_SQUARE};
+
+    TTEntry* entry = tt.probe(hashPosition(position, opponent()));
+    if (entry) {
+        for (int i = 0; i < count; ++i) {
+            if (moves[i].from == entry->from && moves[i].to == entry->to) return moves[i];
+        }
+    }
+
+    stop = false;
+    deadline = nowNs() + 20 * 1000000LL;
+    Search search(tt, stop, deadline);
+    return search.run(position, opponent(), 6, [](const SearchResult&) {}).best;
+}
+
+void SearchService::ponder(const Board& position) {
+    cancel();
+
+    SquareMove predicted = predictReply(position);
+    if (predicted.from == NO_SQUARE) return;
+
+    Board expected = position;
+    expected.applyMove(predicted);
+    ponderKey = hashPosition(expected, engineSide);
+    ponderStart = EngineClock::now();
+    pondering = true;
+    start(expected, LLONG_MAX);
+}
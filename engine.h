@@ -0,0 +1,141 @@
+#ifndef _ENGINE_H_
+#define _ENGINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "checkers.h"
+
+using namespace std;
+
+#define MAX_SEARCH_DEPTH 64
+#define WIN_SCORE 100000
+
+typedef chrono::steady_clock EngineClock;
+
+// Splits a game clock across moves: an even share of what is left over the
+// moves still expected, plus most of the increment.
+class TimeManager {
+	public:
+	TimeManager(long clockMs = 300000, long incrementMs = 0, int expectedMoves = 40)
+	    : remainingMs(clockMs), incrementMs(incrementMs), expectedMoves(expectedMoves), movesPlayed(0) {}
+
+	long budgetMs() const;
+	void moveMade(long elapsedMs); //charges the clock for one engine move
+	long remaining() const { return remainingMs; }
+
+	private:
+	long remainingMs;
+	long incrementMs;
+	int expectedMoves;
+	int movesPlayed;
+};
+
+enum BoundType { EXACT, LOWER_BOUND, UPPER_BOUND };
+
+struct TTEntry {
+	uint64_t key;
+	int score;
+	int8_t depth;
+	int8_t bound;
+	int8_t from;   // best move, NO_SQUARE if none
+	int8_t to;
+	bool solved;   // every line ended before the depth limit, so deeper searches can't change it
+};
+
+// Fixed-size, always-replace table shared by every search of one game, so a
+// ponder search that missed still leaves its subtrees behind for the next one.
+class TranspositionTable {
+	public:
+	explicit TranspositionTable(size_t entries = 1 << 16) : table(entries) {}
+	TTEntry* probe(uint64_t key);
+	void store(uint64_t key, int depth, int score, BoundType bound, const SquareMove& best, bool solved);
+	void clear() { fill(table.begin(), table.end(), TTEntry{}); }
+
+	private:
+	vector<TTEntry> table;
+};
+
+uint64_t hashPosition(const Board& board, Piece::Type toMove);
+
+struct SearchResult {
+	SquareMove best = {NO_SQUARE, NO_SQUARE};
+	int score = 0;
+	int depth = 0;
+	long long nodes = 0;
+};
+
+// Iterative-deepening alpha-beta over Board copies. Cancellation is
+// cooperative: the stop flag and deadline are polled every few nodes, and
+// the deadline may be moved while the search runs.
+class Search {
+	public:
+	Search(TranspositionTable& tt_, const atomic<bool>& stop_, const atomic<long long>& deadline_)
+	    : tt(tt_), stop(stop_), deadline(deadline_) {}
+
+	// onDepth is called with each completed iteration. Depth 1 always
+	// completes unless the search is stopped, so there is a move to play.
+	SearchResult run(const Board& root, Piece::Type toMove, int maxDepth,
+	                 const function<void(const SearchResult&)>& onDepth);
+
+	private:
+	TranspositionTable& tt;
+	const atomic<bool>& stop;
+	const atomic<long long>& deadline;
+	long long nodes = 0;
+	int iterationDepth = 0;
+	bool aborted = false;
+	bool horizonReached = false;
+
+	bool timeUp();
+	SearchResult iterate(const Board& root, Piece::Type toMove, int depth);
+	int alphaBeta(const Board& board, uint64_t key, Piece::Type toMove, int depth, int ply, int alpha, int beta);
+};
+
+// Background search attached to one game. While the opponent is thinking it
+// ponders on the predicted reply; when the real move arrives it either keeps
+// that search (ponder hit) or cancels it and searches the actual position.
+class SearchService {
+	public:
+	SearchService(Piece::Type engineSide_, const TimeManager& clock_ = TimeManager())
+	    : engineSide(engineSide_), clock(clock_) {}
+	~SearchService() { cancel(); }
+
+	// Engine to move in position: returns its move within the time budget
+	SquareMove think(const Board& position);
+	// Engine's move has been played: ponder while the opponent thinks
+	void ponder(const Board& position);
+	void cancel();
+
+	bool lastWasPonderHit() const { return ponderHit; }
+	const TimeManager& timeManager() const { return clock; }
+
+	private:
+	Piece::Type engineSide;
+	TimeManager clock;
+	TranspositionTable tt;
+
+	thread worker;
+	atomic<bool> stop{false};
+	atomic<long long> deadline{0};
+	mutex resultMutex;
+	condition_variable resultReady;
+	SearchResult result;
+	bool finished = true;
+	bool pondering = false;
+	bool ponderHit = false;
+	uint64_t ponderKey = 0;                // position the ponder search is running on
+	EngineClock::time_point ponderStart;
+
+	void start(const Board& position, long long deadlineNs);
+	SearchResult wait();
+	SquareMove predictReply(const Board& position);
+	Piece::Type opponent() const { return engineSide == Piece::WHITE ? Piece::BLACK : Piece::WHITE; }
+};
+
+#endif
@@ -0,0 +1,463 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "move_events.h"
+
+using namespace std;
+
+// Resident Server-Sent Events server pushing moves to waiting players.
+// Browsers keep one GET /events?game=ID connection open each.
+// update_board.cgi sends every committed move as a datagram (see
+// move_events.h) and the server writes it once to each watcher of that
+// game. One thread and one epoll set serve every connection, so a watcher
+// costs a file descriptor and a small output buffer rather than a thread.
+// Anyone can connect, so everything held per client is bounded: connections
+// are capped and must send their headers promptly, and a game is kept only
+// while it is watched, or briefly after, for browsers that reconnect.
+
+#define MAX_REQUEST_SIZE 8192
+#define MAX_PENDING_OUTPUT 65536   // a watcher this far behind is dropped
+#define RECENT_EVENTS 32           // kept per game for Last-Event-ID replay
+#define HEARTBEAT_SECONDS 15
+#define MAX_CONNECTIONS 4096
+#define HEADER_TIMEOUT_SECONDS 10      // to send a complete request
+#define STALE_GAME_SECONDS 300         // unwatched games keep recent events this long
+#define RECONNECT_GRACE_SECONDS 30     // and keep a game without any this long: well past the 3 s retry
+
+struct Connection {
+    int fd;
+    string in;          // request bytes until the headers are complete
+    string out;         // bytes the socket has not taken yet
+    string gameId;      // set once the connection is streaming
+    time_t accepted;
+};
+
+struct Game {
+    vector<int> watchers;
+    deque<pair<long long, string>> recent;
+    time_t lastActive = 0;  // last move or watcher leaving
+};
+
+class EventServer {
+    public:
+    EventServer(const string& host, const string& port, const string& socketPath);
+    void run();
+
+    private:
+    int epollFd;
+    int listenFd;
+    int eventFd;
+    unordered_map<int, Connection> connections;
+    unordered_map<string, Game> games;
+    long long nextEventId = 1;    // server-wide, so ids never repeat when a game is dropped and rejoined
+    time_t lastHeartbeat;
+    time_t lastSweep;
+
+    void watch(int fd, uint32_t events, bool add);
+    void acceptClients();
+    void readFrom(Connection& conn);
+    void handleRequest(Connection& conn);
+    void receiveEvents();
+    void broadcast(const MoveEvent& event);
+    bool send(Connection& conn, const string& data);
+    void flush(Connection& conn);
+    void closeConnection(int fd);
+    void heartbeat();
+    void sweep();
+};
+
+static void fail(const string& what) {
+    throw runtime_error(what + ": " + string(strerror(errno)));
+}
+
+static string headerValue(const string& request, const string& name) {
+    size_t lineStart = request.find("\r\n");
+    while (lineStart != string::npos) {
+        lineStart += 2;
+        size_t lineEnd = request.find("\r\n", lineStart);
+        if (lineEnd == string::npos || lineEnd == lineStart) break;
+
+        size_t colon = request.find(':', lineStart);
+        if (colon != string::npos && colon < lineEnd && colon - lineStart == name.size() &&
+            equal(name.begin(), name.end(), request.begin() + lineStart,
+                  [](char a, char b) { return tolower(a) == tolower(b); })) {
+            size_t valueStart = request.find_first_not_of(' ', colon + 1);
+            return valueStart < lineEnd ? request.substr(valueStart, lineEnd - valueStart) : "";
+        }
+        lineStart = lineEnd;
+    }
+    return "";
+}
+
+static string queryValue(const string& query, const string& key) {
+    size_t pos = 0;
+    while (pos < query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == string::npos) end = query.size();
+        if (query.compare(pos, key.size() + 1, key + "=") == 0) {
+            return query.substr(pos + key.size() + 1, end - pos - key.size() - 1);
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+EventServer::EventServer(const string& host, const string& port, const string& socketPath)
+    : lastHeartbeat(time(nullptr)), lastSweep(lastHeartbeat) {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) fail("epoll_create1");
+
+    struct addrinfo hints{}, *addrs = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs) != 0 || !addrs) {
+        throw runtime_error("Cannot resolve " + host + ":" + port);
+    }
+    listenFd = socket(addrs->ai_family, addrs->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int on = 1;
+    if (listenFd < 0 || setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        ::bind(listenFd, addrs->ai_addr, addrs->ai_addrlen) != 0 || listen(listenFd, SOMAXCONN) != 0) {
+        freeaddrinfo(addrs);
+        fail("Cannot listen on " + host + ":" + port);
+    }
+    freeaddrinfo(addrs);
+
+    struct sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        throw runtime_error("Event socket path too long: " + socketPath);
+    }
+    strcpy(addr.sun_path, socketPath.c_str());
+    unlink(socketPath.c_str());
+    eventFd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (eventFd < 0 || ::bind(eventFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        fail("Cannot bind " + socketPath);
+    }
+    // The CGIs run as the web server's user
+    chmod(socketPath.c_str(), 0666);
+
+    watch(listenFd, EPOLLIN, true);
+    watch(eventFd, EPOLLIN, true);
+}
+
+void EventServer::watch(int fd, uint32_t events, bool add) {
+    struct epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &ev) != 0) fail("epoll_ctl");
+}
+
+void EventServer::run() {
+    vector<struct epoll_event> ready(256);
+    for (;;) {
+        int n = epoll_wait(epollFd, ready.data(), ready.size(), 1000);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fail("epoll_wait");
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = ready[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+            } else if (fd == eventFd) {
+                receiveEvents();
+            } else {
+                auto it = connections.find(fd);
+                if (it == connections.end()) continue;
+                if (ready[i].events & (EPOLLHUP | EPOLLERR)) {
+                    closeConnection(fd);
+                    continue;
+                }
+                if (ready[i].events & EPOLLOUT) flush(it->second);
+                it = connections.find(fd);
+                if (it != connections.end() && (ready[i].events & (EPOLLIN | EPOLLRDHUP))) {
+                    readFrom(it->second);
+                }
+            }
+        }
+        time_t now = time(nullptr);
+        if (now - lastHeartbeat >= HEARTBEAT_SECONDS) heartbeat();
+        if (now != lastSweep) sweep();
+    }
+}
+
+void EventServer::acceptClients() {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                cerr << "accept: " << strerror(errno) << endl;
+            }
+            return;
+        }
+        if (connections.size() >= MAX_CONNECTIONS) {
+            close(fd);
+            continue;
+        }
+        connections[fd] = Connection{fd, "", "", "", time(nullptr)};
+        watch(fd, EPOLLIN | EPOLLRDHUP, true);
+    }
+}
+
+void EventServer::readFrom(Connection& conn) {
+    char buffer[4096];
+    for (;;) {
+        ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            // Streaming clients have nothing more to say; ignore anything they send
+            if (!conn.gameId.empty()) continue;
+            conn.in.append(buffer, n);
+            if (conn.in.find("\r\n\r\n") != string::npos) {
+                handleRequest(conn);
+                return;
+            }
+            if (conn.in.size() > MAX_REQUEST_SIZE) {
+                closeConnection(conn.fd);
+                return;
+            }
+        } else if (n == 0) {
+            closeConnection(conn.fd);
+            return;
+        } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) closeConnection(conn.fd);
+            return;
+        }
+    }
+}
+
+void EventServer::handleRequest(Connection& conn) {
+    string requestLine = conn.in.substr(0, conn.in.find("\r\n"));
+    istringstream line(requestLine);
+    string method, target;
+    line >> method >> target;
+
+    size_t queryStart = target.find('?');
+    string path = target.substr(0, queryStart);
+    string query = queryStart == string::npos ? "" : target.substr(queryStart + 1);
+    string gameId = queryValue(query, "game");
+    if (gameId.empty()) gameId = DEFAULT_GAME_ID;
+
+    // Accept any prefix, so the web server can mount us wherever it likes
+    bool isEvents = path.size() >= 7 && path.compare(path.size() - 7, 7, "/events") == 0;
+    if (method != "GET" || !isEvents || !validGameId(gameId)) {
+        int fd = conn.fd;
+        send(conn, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        closeConnection(fd);
+        return;
+    }
+
+    string lastEventId = headerValue(conn.in, "Last-Event-ID");
+    conn.in.clear();
+    conn.in.shrink_to_fit();
+    conn.gameId = gameId;
+    Game& game = games[gameId];
+    game.watchers.push_back(conn.fd);
+
+    string response = "HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/event-stream\r\n"
+                      "Cache-Control: no-cache\r\n"
+                      "Connection: keep-alive\r\n"
+                      "X-Accel-Buffering: no\r\n"
+                      "\r\n"
+                      "retry: 3000\n\n";
+
+    // A reconnecting browser gets the moves it missed, if we still have them.
+    // A new one is told where the stream stands (an id with no data sets
+    // EventSource's lastEventId without firing an event), so a reconnect
+    // before its first move still asks for what it missed
+    long long lastSeen = atoll(lastEventId.c_str());
+    if (!lastEventId.empty()) {
+        for (const auto& recent : game.recent) {
+            if (recent.first > lastSeen) response += recent.second;
+        }
+    } else {
+        response += "id: " + to_string(nextEventId - 1) + "\n\n";
+    }
+    send(conn, response);
+}
+
+void EventServer::receiveEvents() {
+    char buffer[512];
+    for (;;) {
+        ssize_t n = recv(eventFd, buffer, sizeof(buffer), 0);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                cerr << "recv event: " << strerror(errno) << endl;
+            }
+            return;
+        }
+        MoveEvent event;
+        if (decodeMoveEvent(string(buffer, n), event)) {
+            broadcast(event);
+        } else {
+            cerr << "Ignoring malformed move event" << endl;
+        }
+    }
+}
+
+void EventServer::broadcast(const MoveEvent& event) {
+    // Moves in games nobody has watched lately have no one to go to
+    auto it = games.find(event.gameId);
+    if (it == games.end()) return;
+    Game& game = it->second;
+    game.lastActive = time(nullptr);
+    long long id = nextEventId++;
+
+    // Formatted once, then written to every watcher
+    string message = "id: " + to_string(id) + "\nevent: move\ndata: " + moveEventJson(event) + "\n\n";
+    game.recent.emplace_back(id, message);
+    if (game.recent.size() > RECENT_EVENTS) game.recent.pop_front();
+
+    vector<int> watchers = game.watchers;
+    for (int fd : watchers) {
+        auto conn = connections.find(fd);
+        if (conn != connections.end()) send(conn->second, message);
+    }
+}
+
+// Writes what the socket takes now and queues the rest for EPOLLOUT.
+// Returns false if the connection had to be closed.
+bool EventServer::send(Connection& conn, const string& data) {
+    if (!conn.out.empty()) {
+        if (conn.out.size() + data.size() > MAX_PENDING_OUTPUT) {
+            closeConnection(conn.fd);
+            return false;
+        }
+        conn.out += data;
+        return true;
+    }
+
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(conn.fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            conn.out.assign(data, sent, string::npos);
+            watch(conn.fd, EPOLLIN | EPOLLRDHUP | EPOLLOUT, false);
+            return true;
+        } else {
+            closeConnection(conn.fd);
+            return false;
+        }
+    }
+    return true;
+}
+
+void EventServer::flush(Connection& conn) {
+    string pending;
+    pending.swap(conn.out);
+    if (pending.empty() || !send(conn, pending)) return;
+    if (conn.out.empty()) watch(conn.fd, EPOLLIN | EPOLLRDHUP, false);
+}
+
+void EventServer::closeConnection(int fd) {
+    auto it = connections.find(fd);
+    if (it == connections.end()) return;
+
+    if (!it->second.gameId.empty()) {
+        auto game = games.find(it->second.gameId);
+        if (game != games.end()) {
+            auto& w = game->second.watchers;
+            w.erase(remove(w.begin(), w.end(), fd), w.end());
+            // Kept for sweep() to expire, so a move made while the browser
+            // reconnects is still there to replay
+            game->second.lastActive = time(nullptr);
+        }
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(it);
+}
+
+// Comment lines keep idle streams from being timed out by proxies
+void EventServer::heartbeat() {
+    lastHeartbeat = time(nullptr);
+    vector<int> streaming;
+    for (const auto& entry : connections) {
+        if (!entry.second.gameId.empty()) streaming.push_back(entry.first);
+    }
+    for (int fd : streaming) {
+        auto it = connections.find(fd);
+        if (it != connections.end()) send(it->second, ": keep-alive\n\n");
+    }
+}
+
+void EventServer::sweep() {
+    time_t now = time(nullptr);
+    lastSweep = now;
+
+    // Connections that never finished their request
+    vector<int> stalled;
+    for (const auto& entry : connections) {
+        if (entry.second.gameId.empty() && now - entry.second.accepted >= HEADER_TIMEOUT_SECONDS) {
+            stalled.push_back(entry.first);
+        }
+    }
+    for (int fd : stalled) closeConnection(fd);
+
+    // Unwatched games, once a reconnecting browser is unlikely to want their moves
+    for (auto it = games.begin(); it != games.end();) {
+        const Game& game = it->second;
+        time_t keep = game.recent.empty() ? RECONNECT_GRACE_SECONDS : STALE_GAME_SECONDS;
+        if (game.watchers.empty() && now - game.lastActive >= keep) {
+            it = games.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    string host = "127.0.0.1", port = "8090", socketPath = eventSocketPath();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--listen") {
+            string target = argv[i + 1];
+            size_t colon = target.rfind(':');
+            host = target.substr(0, colon);
+            if (colon != string::npos) port = target.substr(colon + 1);
+        } else if (arg == "--socket") {
+            socketPath = argv[i + 1];
+        } else {
+            cerr << "usage: event_server [--listen HOST:PORT] [--socket PATH]" << endl;
+            return 2;
+        }
+    }
+
+    try {
+        signal(SIGPIPE, SIG_IGN);
+
+        // Room for MAX_CONNECTIONS, if the hard limit allows
+        struct rlimit files;
+        if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < MAX_CONNECTIONS + 16) {
+            files.rlim_cur = min<rlim_t>(files.rlim_max, MAX_CONNECTIONS + 16);
+            setrlimit(RLIMIT_NOFILE, &files);
+        }
+        EventServer server(host, port, socketPath);
+        cerr << "Serving move events on " << host << ":" << port << ", moves from " << socketPath << endl;
+        server.run();
+    } catch (const exception& e) {
+        cerr << "event_server: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
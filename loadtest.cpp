@@ -0,0 +1,586 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "checkers.h"
+
+using namespace std;
+
+// Load generator for update_board.cgi / checkers.cgi.
+// Each worker plays games (random legal ones, or recorded ones with --replay)
+// and sends every move the way the browser does: a form-encoded POST carrying
+// the move and the current board state. Targets are either the CGI binaries,
+// run the way a web server runs them (CONTENT_LENGTH set, body on stdin), or
+// a local HTTP endpoint.
+
+struct Options {
+    string moveCgi = "./update_board.cgi";
+    string pageCgi;                 // optional checkers.cgi, fetched at the start of each game
+    string host;                    // HTTP mode when set
+    string port = "80";
+    string movePath = "/update_board.cgi";
+    string pagePath;
+    string replayFile;
+    string recordFile;
+    string workDir = "/tmp/checkers-loadtest";
+    int concurrency = 1;
+    long requests = 1000;           // total move requests, ignored when seconds > 0
+    double seconds = 0;
+    int maxPlies = 200;
+    unsigned seed = 1;
+};
+
+struct CgiUsage {
+    double userMs = 0;
+    double sysMs = 0;
+    long maxRssKb = 0;
+    long minorFaults = 0;
+};
+
+struct WorkerStats {
+    vector<double> moveLatencyMs;
+    vector<double> pageLatencyMs;
+    long errors = 0;
+    long games = 0;
+    CgiUsage usage;                 // summed over every CGI child this worker ran
+    long children = 0;
+    long allocations = 0;           // summed over responses from -DCOUNT_ALLOCATIONS builds
+    long countedResponses = 0;
+};
+
+struct Move {
+    int fromRow, fromCol, toRow, toCol;
+};
+
+static void usage() {
+    cerr << "usage: loadtest [options]\n"
+         << "  --cgi PATH          update_board.cgi to run (default ./update_board.cgi)\n"
+         << "  --page-cgi PATH     also run checkers.cgi once at the start of every game\n"
+         << "  --http HOST:PORT    send requests to a local web server instead of running CGIs\n"
+         << "  --path PATH         move URL path in --http mode (default /update_board.cgi)\n"
+         << "  --page-path PATH    page URL path fetched at game start in --http mode\n"
+         << "  --replay FILE       replay recorded games, one per line, moves like B6-A5\n"
+         << "  --record FILE       append the random games played to FILE for later --replay\n"
+         << "  -c N                concurrent workers (default 1)\n"
+         << "  -n N                total move requests (default 1000)\n"
+         << "  -d SECONDS          run for a fixed time instead of -n\n"
+         << "  --max-plies N       restart a random game after N moves (default 200)\n"
+         << "  --seed N            random game seed (default 1)\n"
+         << "  --workdir DIR       scratch directory for CGI children (default /tmp/checkers-loadtest)\n";
+}
+
+static string absolutePath(const string& path) {
+    char resolved[PATH_MAX];
+    if (!realpath(path.c_str(), resolved)) {
+        throw runtime_error("Cannot find " + path + ": " + string(strerror(errno)));
+    }
+    return resolved;
+}
+
+static string urlEncode(const string& value) {
+    static const char hex[] = "0123456789ABCDEF";
+    string result;
+    for (unsigned char c : value) {
+        if (isalnum(c) || c == '-' || c == '_' || c == '.') {
+            result += c;
+        } else {
+            result += '%';
+            result += hex[c >> 4];
+            result += hex[c & 15];
+        }
+    }
+    return result;
+}
+
+// Same fields, same 1-based rows, as the form in index.html. Each worker
+// plays under its own gameId so its moves never reach real players' games
+static string moveBody(const Move& m, const string& boardState, const string& gameId) {
+    return "fromCol=" + to_string(m.fromCol) + "&fromRow=" + to_string(m.fromRow + 1) +
+           "&toCol=" + to_string(m.toCol) + "&toRow=" + to_string(m.toRow + 1) +
+           "&boardAsString=" + urlEncode(boardState) + "&currentBoardState=" +
+           "&gameId=" + urlEncode(gameId);
+}
+
+static string extractBoardState(const string& response) {
+    const string marker = "id='currentBoardState' value='";
+    size_t pos = response.find(marker);
+    if (pos == string::npos) return "";
+    pos += marker.length();
+    size_t end = response.find('\'', pos);
+    if (end == string::npos) return "";
+    return response.substr(pos, end - pos);
+}
+
+// CGIs built with -DCOUNT_ALLOCATIONS end their response with
+// "<!-- allocations: N -->", their process's operator new count
+static bool allocationMarker(const string& response, long& count) {
+    const string marker = "<!-- allocations: ";
+    size_t pos = response.rfind(marker);
+    if (pos == string::npos) return false;
+    count = strtol(response.c_str() + pos + marker.length(), nullptr, 10);
+    return true;
+}
+
+static string initialBoardState() {
+    Board board;
+    board.initPieces();
+    return board.boardToString();
+}
+
+static vector<Move> legalMoves(const string& boardState, Piece::Type side) {
+    Board board;
+    board.stringToBoard(boardState);
+    vector<Move> moves;
+    for (int square = 0; square < NUM_SQUARES; ++square) {
+        int fromRow = SQUARE_TABLES.row[square], fromCol = SQUARE_TABLES.col[square];
+        if (board.pieceAt(fromRow, fromCol) != side) continue;
+        for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+            for (int to : {SQUARE_TABLES.neighbour[square][d], SQUARE_TABLES.jump[square][d]}) {
+                if (to == NO_SQUARE) continue;
+                int toRow = SQUARE_TABLES.row[to], toCol = SQUARE_TABLES.col[to];
+                if (board.valid_move(fromRow, fromCol, toRow, toCol)) {
+                    moves.push_back({fromRow, fromCol, toRow, toCol});
+                }
+            }
+        }
+    }
+    return moves;
+}
+
+static string moveName(const Move& m) {
+    string name = "A1-A1";
+    name[0] = 'A' + m.fromCol;
+    name[1] = '1' + m.fromRow;
+    name[3] = 'A' + m.toCol;
+    name[4] = '1' + m.toRow;
+    return name;
+}
+
+// Recorded games use the board's labels: columns A-H, rows 1-8, e.g. "B6-A5"
+static vector<vector<Move>> loadGames(const string& filename) {
+    ifstream file(filename);
+    if (!file) throw runtime_error("Cannot open " + filename);
+
+    vector<vector<Move>> games;
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        istringstream ss(line);
+        string token;
+        vector<Move> game;
+        while (ss >> token) {
+            if (token.size() != 5 || token[2] != '-') {
+                throw runtime_error("Bad move '" + token + "' in " + filename);
+            }
+            Move m{token[1] - '1', toupper(token[0]) - 'A', token[4] - '1', toupper(token[3]) - 'A'};
+            if (m.fromRow < 0 || m.fromRow >= BOARD_SIZE || m.fromCol < 0 || m.fromCol >= BOARD_SIZE ||
+                m.toRow < 0 || m.toRow >= BOARD_SIZE || m.toCol < 0 || m.toCol >= BOARD_SIZE) {
+                throw runtime_error("Move '" + token + "' is off the board in " + filename);
+            }
+            game.push_back(m);
+        }
+        if (!game.empty()) games.push_back(game);
+    }
+    if (games.empty()) throw runtime_error("No games in " + filename);
+    return games;
+}
+
+static double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Runs one CGI request in workDir: environment as a web server sets it, body
+// piped to stdin, stdout collected. The child's rusage is added to stats.
+static bool runCgi(const string& program, const string& method, const string& body,
+                   const string& workDir, string& response, WorkerStats& stats) {
+    // Close-on-exec, so children forked by other workers don't hold our pipe
+    // ends open; dup2 clears the flag on the child's stdin/stdout
+    int in[2], out[2];
+    if (pipe2(in, O_CLOEXEC) != 0) return false;
+    if (pipe2(out, O_CLOEXEC) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return false;
+    }
+
+    vector<string> env = {
+        "GATEWAY_INTERFACE=CGI/1.1",
+        "REQUEST_METHOD=" + method,
+        "SCRIPT_NAME=/" + program.substr(program.find_last_of('/') + 1),
+        "SERVER_PROTOCOL=HTTP/1.1",
+        "PATH=/usr/bin:/bin",
+        // No event server listens here, so children publish their moves nowhere
+        "CHECKERS_EVENT_SOCKET=" + workDir + "/events.sock",
+    };
+    if (method == "POST") {
+        env.push_back("CONTENT_TYPE=application/x-www-form-urlencoded");
+        env.push_back("CONTENT_LENGTH=" + to_string(body.size()));
+    }
+    vector<char*> envp;
+    for (auto& e : env) envp.push_back(&e[0]);
+    envp.push_back(nullptr);
+    char* argv[] = {const_cast<char*>(program.c_str()), nullptr};
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(in[0]); close(in[1]); close(out[0]); close(out[1]);
+        return false;
+    }
+    if (pid == 0) {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        close(in[0]); close(in[1]); close(out[0]); close(out[1]); close(devNull);
+        if (chdir(workDir.c_str()) != 0) _exit(127);
+        execve(argv[0], argv, envp.data());
+        _exit(127);
+    }
+
+    close(in[0]);
+    close(out[1]);
+    // Bodies are capped at MAX_CONTENT_LENGTH, well under the pipe buffer
+    ssize_t written = write(in[1], body.data(), body.size());
+    close(in[1]);
+
+    response.clear();
+    char buffer[8192];
+    ssize_t n;
+    while ((n = read(out[0], buffer, sizeof(buffer))) > 0 || (n < 0 && errno == EINTR)) {
+        if (n > 0) response.append(buffer, n);
+    }
+    close(out[0]);
+
+    int status = 0;
+    struct rusage ru;
+    while (wait4(pid, &status, 0, &ru) < 0) {
+        if (errno != EINTR) return false;
+    }
+    stats.usage.userMs += ru.ru_utime.tv_sec * 1e3 + ru.ru_utime.tv_usec / 1e3;
+    stats.usage.sysMs += ru.ru_stime.tv_sec * 1e3 + ru.ru_stime.tv_usec / 1e3;
+    stats.usage.maxRssKb += ru.ru_maxrss;
+    stats.usage.minorFaults += ru.ru_minflt;
+    stats.children++;
+
+    return written == static_cast<ssize_t>(body.size()) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// One HTTP/1.0 request per connection, read until the server closes it
+static bool runHttp(const Options& opt, const string& path, const string& method,
+                    const string& body, string& response) {
+    struct addrinfo hints{}, *addrs = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(opt.host.c_str(), opt.port.c_str(), &hints, &addrs) != 0) return false;
+
+    int fd = -1;
+    for (auto* a = addrs; a; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addrs);
+    if (fd < 0) return false;
+
+    string request = method + " " + path + " HTTP/1.0\r\nHost: " + opt.host + "\r\n";
+    if (method == "POST") {
+        request += "Content-Type: application/x-www-form-urlencoded\r\n";
+        request += "Content-Length: " + to_string(body.size()) + "\r\n";
+    }
+    request += "\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(fd);
+            return false;
+        }
+        sent += n;
+    }
+
+    response.clear();
+    char buffer[8192];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0 || (n < 0 && errno == EINTR)) {
+        if (n > 0) response.append(buffer, n);
+    }
+    close(fd);
+    return response.compare(0, 12, "HTTP/1.1 200") == 0 || response.compare(0, 12, "HTTP/1.0 200") == 0;
+}
+
+class Worker {
+    public:
+    Worker(const Options& opt_, const vector<vector<Move>>& games_, int id_,
+           atomic<long>& remaining_, chrono::steady_clock::time_point deadline_, ofstream* record_)
+        : opt(opt_), games(games_), id(id_), remaining(remaining_), deadline(deadline_),
+          record(record_), rng(opt_.seed + id_) {
+        workDir = opt.workDir + "/worker" + to_string(id);
+        gameId = "loadtest-" + to_string(id);
+        mkdir(workDir.c_str(), 0755);
+    }
+
+    void run() {
+        size_t nextGame = id;
+        while (!finished()) {
+            stats.games++;
+            loadPage();
+            if (games.empty()) {
+                playRandomGame();
+            } else {
+                playRecordedGame(games[nextGame % games.size()]);
+                nextGame += opt.concurrency;
+            }
+        }
+    }
+
+    WorkerStats stats;
+
+    private:
+    const Options& opt;
+    const vector<vector<Move>>& games;
+    int id;
+    atomic<long>& remaining;
+    chrono::steady_clock::time_point deadline;
+    ofstream* record;
+    mt19937 rng;
+    string workDir;
+    string gameId;
+    string response;
+
+    bool finished() {
+        if (opt.seconds > 0) return chrono::steady_clock::now() >= deadline;
+        return remaining.load() <= 0;
+    }
+
+    bool takeRequest() {
+        if (opt.seconds > 0) return chrono::steady_clock::now() < deadline;
+        return remaining.fetch_sub(1) > 0;
+    }
+
+    void loadPage() {
+        if (opt.pageCgi.empty() && opt.pagePath.empty()) return;
+
+        auto start = chrono::steady_clock::now();
+        bool ok = opt.host.empty() ? runCgi(opt.pageCgi, "GET", "", workDir, response, stats)
+                                   : runHttp(opt, opt.pagePath, "GET", "", response);
+        stats.pageLatencyMs.push_back(elapsedMs(start));
+        if (!ok || extractBoardState(response).empty()) stats.errors++;
+        countAllocations();
+    }
+
+    void countAllocations() {
+        long count;
+        if (allocationMarker(response, count)) {
+            stats.allocations += count;
+            stats.countedResponses++;
+        }
+    }
+
+    // Returns the board state the server sent back, empty on failure
+    string sendMove(const Move& m, const string& boardState) {
+        string body = moveBody(m, boardState, gameId);
+        auto start = chrono::steady_clock::now();
+        bool ok = opt.host.empty() ? runCgi(opt.moveCgi, "POST", body, workDir, response, stats)
+                                   : runHttp(opt, opt.movePath, "POST", body, response);
+        stats.moveLatencyMs.push_back(elapsedMs(start));
+        countAllocations();
+
+        string next = ok ? extractBoardState(response) : "";
+        if (next.empty()) stats.errors++;
+        return next;
+    }
+
+    void playRandomGame() {
+        string boardState = initialBoardState();
+        bool whiteToMove = true;
+        string played;
+        for (int ply = 0; ply < opt.maxPlies; ++ply) {
+            vector<Move> moves = legalMoves(boardState, whiteToMove ? Piece::WHITE : Piece::BLACK);
+            if (moves.empty() || !takeRequest()) break;
+
+            uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+            const Move& m = moves[pick(rng)];
+            boardState = sendMove(m, boardState);
+            if (boardState.empty()) break;
+            played += (played.empty() ? "" : " ") + moveName(m);
+            whiteToMove = !whiteToMove;
+        }
+        recordGame(played);
+    }
+
+    void recordGame(const string& played) {
+        static mutex recordMutex;
+        if (!record || played.empty()) return;
+        lock_guard<mutex> lock(recordMutex);
+        *record << played << "\n";
+    }
+
+    void playRecordedGame(const vector<Move>& game) {
+        string boardState = initialBoardState();
+        for (const Move& m : game) {
+            if (!takeRequest()) return;
+            boardState = sendMove(m, boardState);
+            if (boardState.empty()) return;
+        }
+    }
+};
+
+static double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+static void printLatency(const string& name, vector<double>& samples) {
+    if (samples.empty()) return;
+    sort(samples.begin(), samples.end());
+    cout << name << " latency (ms): p50 " << percentile(samples, 0.50)
+         << "  p99 " << percentile(samples, 0.99)
+         << "  p999 " << percentile(samples, 0.999)
+         << "  max " << samples.back() << "\n";
+}
+
+static Options parseOptions(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto value = [&]() -> string {
+            if (i + 1 >= argc) throw runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--cgi") opt.moveCgi = value();
+        else if (arg == "--page-cgi") opt.pageCgi = value();
+        else if (arg == "--http") {
+            string target = value();
+            size_t colon = target.rfind(':');
+            opt.host = target.substr(0, colon);
+            if (colon != string::npos) opt.port = target.substr(colon + 1);
+        }
+        else if (arg == "--path") opt.movePath = value();
+        else if (arg == "--page-path") opt.pagePath = value();
+        else if (arg == "--replay") opt.replayFile = value();
+        else if (arg == "--record") opt.recordFile = value();
+        else if (arg == "-c") opt.concurrency = stoi(value());
+        else if (arg == "-n") opt.requests = stol(value());
+        else if (arg == "-d") opt.seconds = stod(value());
+        else if (arg == "--max-plies") opt.maxPlies = stoi(value());
+        else if (arg == "--seed") opt.seed = stoul(value());
+        else if (arg == "--workdir") opt.workDir = value();
+        else if (arg == "-h" || arg == "--help") {
+            usage();
+            exit(0);
+        }
+        else throw runtime_error("Unknown option " + arg);
+    }
+    if (opt.concurrency < 1) throw runtime_error("Concurrency must be at least 1");
+    return opt;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options opt = parseOptions(argc, argv);
+        if (opt.host.empty()) {
+            // Children run in per-worker scratch directories so concurrent
+            // saveState() calls don't race on one game_state.txt
+            opt.moveCgi = absolutePath(opt.moveCgi);
+            if (!opt.pageCgi.empty()) opt.pageCgi = absolutePath(opt.pageCgi);
+            mkdir(opt.workDir.c_str(), 0755);
+        }
+
+        vector<vector<Move>> games;
+        if (!opt.replayFile.empty()) games = loadGames(opt.replayFile);
+
+        unique_ptr<ofstream> record;
+        if (!opt.recordFile.empty()) {
+            record.reset(new ofstream(opt.recordFile, ios::app));
+            if (!*record) throw runtime_error("Cannot open " + opt.recordFile);
+        }
+
+        atomic<long> remaining(opt.requests);
+        auto start = chrono::steady_clock::now();
+        auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(
+                                    chrono::duration<double>(opt.seconds));
+
+        vector<unique_ptr<Worker>> workers;
+        for (int i = 0; i < opt.concurrency; ++i) {
+            workers.emplace_back(new Worker(opt, games, i, remaining, deadline, record.get()));
+        }
+        vector<thread> threads;
+        for (auto& w : workers) threads.emplace_back(&Worker::run, w.get());
+        for (auto& t : threads) t.join();
+        double seconds = elapsedMs(start) / 1e3;
+
+        WorkerStats total;
+        for (auto& w : workers) {
+            const WorkerStats& s = w->stats;
+            total.moveLatencyMs.insert(total.moveLatencyMs.end(), s.moveLatencyMs.begin(), s.moveLatencyMs.end());
+            total.pageLatencyMs.insert(total.pageLatencyMs.end(), s.pageLatencyMs.begin(), s.pageLatencyMs.end());
+            total.errors += s.errors;
+            total.games += s.games;
+            total.usage.userMs += s.usage.userMs;
+            total.usage.sysMs += s.usage.sysMs;
+            total.usage.maxRssKb += s.usage.maxRssKb;
+            total.usage.minorFaults += s.usage.minorFaults;
+            total.children += s.children;
+            total.allocations += s.allocations;
+            total.countedResponses += s.countedResponses;
+        }
+
+        size_t requests = total.moveLatencyMs.size() + total.pageLatencyMs.size();
+        cout << "target: " << (opt.host.empty() ? opt.moveCgi : opt.host + ":" + opt.port + opt.movePath)
+             << "  concurrency " << opt.concurrency << "\n";
+        cout << "requests: " << requests << " (" << total.moveLatencyMs.size() << " moves, "
+             << total.pageLatencyMs.size() << " page loads, " << total.games << " games), errors: "
+             << total.errors << "\n";
+        cout << "elapsed: " << seconds << " s  throughput: " << requests / seconds << " req/s  ("
+             << total.moveLatencyMs.size() / seconds << " moves/s)\n";
+        printLatency("move", total.moveLatencyMs);
+        printLatency("page", total.pageLatencyMs);
+
+        if (total.children > 0) {
+            // rusage has no allocation counts; RSS and page faults show memory touched
+            cout << "per CGI request: user " << total.usage.userMs / total.children << " ms, sys "
+                 << total.usage.sysMs / total.children << " ms, max RSS "
+                 << total.usage.maxRssKb / total.children << " KB, minor page faults "
+                 << static_cast<double>(total.usage.minorFaults) / total.children << "\n";
+        }
+        if (total.countedResponses > 0) {
+            cout << "heap allocations per request: "
+                 << static_cast<double>(total.allocations) / total.countedResponses
+                 << " (operator new calls, " << total.countedResponses << " counted responses)\n";
+        } else {
+            cout << "heap allocations: not counted; build the CGIs with -DCOUNT_ALLOCATIONS to report them\n";
+        }
+        struct rusage self;
+        getrusage(RUSAGE_SELF, &self);
+        cout << "load generator: user " << self.ru_utime.tv_sec * 1e3 + self.ru_utime.tv_usec / 1e3
+             << " ms, sys " << self.ru_stime.tv_sec * 1e3 + self.ru_stime.tv_usec / 1e3 << " ms\n";
+        return total.errors == 0 ? 0 : 1;
+    } catch (const exception& e) {
+        cerr << "loadtest: " << e.what() << endl;
+        usage();
+        return 2;
+    }
+}
@@ -1,6 +1,10 @@
 #include "checkers.h"
 #include <iostream>
 
+#ifdef COUNT_ALLOCATIONS
+#include "alloc_counter.h"
+#endif
+
 using namespace std;
 
 int main() {
@@ -29,5 +33,9 @@ int main() {
         cout << "Content-Type: text/html\n\n";
         cout << "Error: " << e.what() << endl;
     }
+#ifdef COUNT_ALLOCATIONS
+    // Read by loadtest, which reports heap allocations per request
+    cout << "<!-- allocations: " << allocationCount() << " -->\n";
+#endif
     return 0;
 }
@@ -0,0 +1,119 @@
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "move_events.h"
+
+using namespace std;
+
+static const char* const STATE_NAMES[] = {"ongoing", "white_win", "black_win", "draw"};
+
+bool validGameId(const char* id, size_t length) {
+    if (length == 0 || length > MAX_GAME_ID_LENGTH) return false;
+    for (size_t i = 0; i < length; ++i) {
+        char c = id[i];
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') return false;
+    }
+    return true;
+}
+
+const char* eventSocketPath() {
+    const char* path = getenv("CHECKERS_EVENT_SOCKET");
+    return (path && *path) ? path : DEFAULT_EVENT_SOCKET;
+}
+
+MoveEvent makeMoveEvent(const char* gameId, const Board& board,
+                        int fromRow, int fromCol, int toRow, int toCol) {
+    MoveEvent event = {{}, fromRow, fromCol, toRow, toCol, -1, -1, board.getGameState(), true};
+    strncpy(event.gameId, gameId, MAX_GAME_ID_LENGTH);
+
+    int fromSq = SQUARE_TABLES.index[fromRow][fromCol];
+    int toSq = SQUARE_TABLES.index[toRow][toCol];
+    if (fromSq != NO_SQUARE && toSq != NO_SQUARE) {
+        int between = SQUARE_TABLES.jumped[fromSq][toSq];
+        if (between != NO_SQUARE) {
+            event.capturedRow = SQUARE_TABLES.row[between];
+            event.capturedCol = SQUARE_TABLES.col[between];
+        }
+    }
+
+    // Each CGI request starts a fresh Board, so its turn flag can't be
+    // trusted; the side to move is whoever did not just move
+    event.whiteToMove = board.pieceAt(toRow, toCol) != Piece::WHITE;
+
+    // updateGameState checked for stalemate with that same flag. A win does
+    // not depend on the turn, but whether the game is drawn does
+    if (!board.checkmate()) {
+        Piece::Type toMove = event.whiteToMove ? Piece::WHITE : Piece::BLACK;
+        event.state = board.hasValidMoves(toMove) ? ONGOING : DRAW;
+    }
+    return event;
+}
+
+size_t encodeMoveEvent(const MoveEvent& event, char* out) {
+    int length = snprintf(out, MAX_EVENT_DATAGRAM, "%s %d %d %d %d %d %d %d %c",
+                          event.gameId, event.fromRow, event.fromCol, event.toRow, event.toCol,
+                          event.capturedRow, event.capturedCol, static_cast<int>(event.state),
+                          event.whiteToMove ? 'w' : 'b');
+    return min(static_cast<size_t>(max(length, 0)), static_cast<size_t>(MAX_EVENT_DATAGRAM - 1));
+}
+
+static bool onBoard(int row, int col) {
+    return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+}
+
+bool decodeMoveEvent(const string& datagram, MoveEvent& event) {
+    istringstream in(datagram);
+    string gameId;
+    int state;
+    char turn;
+    if (!(in >> gameId >> event.fromRow >> event.fromCol >> event.toRow >> event.toCol
+             >> event.capturedRow >> event.capturedCol >> state >> turn)) {
+        return false;
+    }
+    if (!validGameId(gameId) ||
+        !onBoard(event.fromRow, event.fromCol) || !onBoard(event.toRow, event.toCol) ||
+        (event.capturedRow != -1 && !onBoard(event.capturedRow, event.capturedCol)) ||
+        state < ONGOING || state > DRAW || (turn != 'w' && turn != 'b')) {
+        return false;
+    }
+    strcpy(event.gameId, gameId.c_str());
+    event.state = static_cast<GameState>(state);
+    event.whiteToMove = turn == 'w';
+    return true;
+}
+
+string moveEventJson(const MoveEvent& event) {
+    ostringstream out;
+    out << "{\"from\":[" << event.fromRow << ',' << event.fromCol << "],\"to\":["
+        << event.toRow << ',' << event.toCol << "],\"captured\":";
+    if (event.capturedRow == -1) {
+        out << "null";
+    } else {
+        out << '[' << event.capturedRow << ',' << event.capturedCol << ']';
+    }
+    out << ",\"turn\":\"" << (event.whiteToMove ? "white" : "black")
+        << "\",\"state\":\"" << STATE_NAMES[event.state] << "\"}";
+    return out.str();
+}
+
+bool publishMoveEvent(const MoveEvent& event) {
+    const char* path = eventSocketPath();
+    struct sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return false;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    char datagram[MAX_EVENT_DATAGRAM];
+    size_t length = encodeMoveEvent(event, datagram);
+    ssize_t sent = sendto(fd, datagram, length, 0,
+                          reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    close(fd);
+    return sent == static_cast<ssize_t>(length);
+}
@@ -0,0 +1,51 @@
+#ifndef _MOVE_EVENTS_H_
+#define _MOVE_EVENTS_H_
+
+#include <string>
+#include "checkers.h"
+
+using namespace std;
+
+// Move notifications from update_board.cgi to the resident event server.
+// Each committed move is sent as one datagram on a local Unix socket; the
+// server fans it out to everyone watching that game. Sending is best-effort
+// and never blocks or fails the move itself, and, like the rest of the move
+// request, it does not touch the heap.
+
+#define DEFAULT_EVENT_SOCKET "/tmp/checkers-events.sock"
+#define DEFAULT_GAME_ID "default"
+#define MAX_GAME_ID_LENGTH 64
+#define MAX_EVENT_DATAGRAM 128
+
+struct MoveEvent {
+	char gameId[MAX_GAME_ID_LENGTH + 1];
+	int fromRow, fromCol, toRow, toCol;
+	int capturedRow, capturedCol;  // -1 when nothing was captured
+	GameState state;
+	bool whiteToMove;
+};
+
+// Game ids are 1 to MAX_GAME_ID_LENGTH letters, digits, '-' or '_'
+bool validGameId(const char* id, size_t length);
+inline bool validGameId(const string& id) { return validGameId(id.data(), id.size()); }
+
+// Socket path, from CHECKERS_EVENT_SOCKET when set
+const char* eventSocketPath();
+
+// Describes a move that has just been applied to board
+// gameId must pass validGameId
+MoveEvent makeMoveEvent(const char* gameId, const Board& board,
+                        int fromRow, int fromCol, int toRow, int toCol);
+
+// Datagram form: "gameId fromRow fromCol toRow toCol capturedRow capturedCol state turn"
+// Writes at most MAX_EVENT_DATAGRAM bytes to out and returns the length
+size_t encodeMoveEvent(const MoveEvent& event, char* out);
+bool decodeMoveEvent(const string& datagram, MoveEvent& event);
+
+// The delta pushed to browsers as the data of an SSE "move" event
+string moveEventJson(const MoveEvent& event);
+
+// Returns false if the server could not be reached; the caller carries on
+bool publishMoveEvent(const MoveEvent& event);
+
+#endif
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <string>
+#include <vector>
+#include "engine.h"
+
+using namespace std;
+
+// Engine reply latency, with and without pondering.
+// The engine plays black against a simulated white player who thinks for a
+// fixed time before each move and mostly plays a short search's choice.
+// Games start with only the back two ranks filled: from the full opening
+// position a capture, which blocks all other moves, comes within a few plies.
+
+struct Options {
+    int games = 10;
+    long clockMs = 10000;     // engine clock per game
+    int thinkMs = 300;        // simulated opponent thinking time
+    int maxPlies = 60;
+};
+
+struct Latencies {
+    vector<double> replyMs;
+    int ponderHits = 0;
+};
+
+static string openingPosition() {
+    string state;
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            bool dark = (i + j) % 2 == 0;
+            if (!state.empty()) state += ",";
+            state += !dark ? "0" : i < 2 ? "1" : i >= BOARD_SIZE - 2 ? "2" : "0";
+        }
+    }
+    return state;
+}
+
+static SquareMove opponentMove(const Board& board, mt19937& rng, TranspositionTable& tt) {
+    SquareMove moves[MAX_MOVES];
+    int count = board.generateMoves(Piece::WHITE, moves);
+    if (count == 0) return {NO_SQUARE, NO_SQUARE};
+
+    // One move in four is a surprise the engine cannot have predicted well
+    if (uniform_int_distribution<int>(0, 3)(rng) == 0) {
+        return moves[uniform_int_distribution<int>(0, count - 1)(rng)];
+    }
+    atomic<bool> stop(false);
+    atomic<long long> deadline(LLONG_MAX);
+    Search search(tt, stop, deadline);
+    return search.run(board, Piece::WHITE, 4, [](const SearchResult&) {}).best;
+}
+
+static void playGames(const Options& opt, bool ponder, Latencies& out) {
+    mt19937 rng(7);
+    for (int game = 0; game < opt.games; ++game) {
+        Board board;
+        board.stringToBoard(openingPosition());
+        SearchService engine(Piece::BLACK, TimeManager(opt.clockMs));
+        TranspositionTable opponentTable;
+
+        for (int ply = 0; ply < opt.maxPlies; ply += 2) {
+            SquareMove human = opponentMove(board, rng, opponentTable);
+            if (human.from == NO_SQUARE) break;
+            this_thread::sleep_for(chrono::milliseconds(opt.thinkMs));
+            board.applyMove(human);
+
+            auto start = EngineClock::now();
+            SquareMove reply = engine.think(board);
+            // The first reply of a game has had nothing to ponder on
+            if (ply > 0) out.replyMs.push_back(chrono::duration<double, milli>(EngineClock::now() - start).count());
+            if (engine.lastWasPonderHit()) out.ponderHits++;
+            if (reply.from == NO_SQUARE) break;
+
+            board.applyMove(reply);
+            if (ponder) engine.ponder(board);
+        }
+    }
+}
+
+static void report(const string& name, Latencies& l) {
+    if (l.replyMs.empty()) return;
+    sort(l.replyMs.begin(), l.replyMs.end());
+    double total = 0;
+    for (double ms : l.replyMs) total += ms;
+    cout << name << ": " << l.replyMs.size() << " replies, mean " << total / l.replyMs.size()
+         << " ms, p50 " << l.replyMs[l.replyMs.size() / 2] << " ms, max " << l.replyMs.back()
+         << " ms, ponder hits " << l.ponderHits << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (argc > 1) opt.games = stoi(argv[1]);
+    if (argc > 2) opt.thinkMs = stoi(argv[2]);
+
+    Latencies cold, pondering;
+    playGames(opt, false, cold);
+    playGames(opt, true, pondering);
+
+    cout << "engine clock " << opt.clockMs << " ms/game, opponent thinks " << opt.thinkMs << " ms/move\n";
+    report("search on request", cold);
+    report("with pondering   ", pondering);
+    return 0;
+}
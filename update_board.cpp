@@ -1,80 +1,16 @@
 #include <iostream>
 #include <cstdlib>
 #include <string>
-#include <sstream>
 #include <cstring>
-#include <memory>
-#include <vector>
 #include "checkers.h"
+#include "cgi_form.h"
+#include "move_events.h"
 
-using namespace std;
-
-string getPostData() {
-    const char* contentLengthEnv = getenv("CONTENT_LENGTH");
-    if (!contentLengthEnv) {
-        throw runtime_error("No Content-Length header");
-    }
-
-    size_t contentLength = stoul(contentLengthEnv);
-    const size_t maxSize = MAX_CONTENT_LENGTH;
-
-    if (contentLength > maxSize) {
-        throw runtime_error("Input exceeds maximum allowed size");
-    }
-
-    // Use vector for dynamic memory allocation
-    vector<char> buffer(contentLength + 1, 0);
-    
-    // Read exactly the number of bytes specified
-    cin.read(buffer.data(), contentLength);
-    size_t bytesRead = cin.gcount();
-
-    if (bytesRead != contentLength) {
-        throw runtime_error("Incomplete data read");
-    }
-
-    return string(buffer.data());
-}
+#ifdef COUNT_ALLOCATIONS
+#include "alloc_counter.h"
+#endif
 
-string getFormValue(const string& data, const string& key) {
-    string keyStr = key + "=";
-    size_t pos = data.find(keyStr);
-    if (pos == string::npos) return "";
-    
-    pos += keyStr.length();
-    size_t endPos = data.find('&', pos);
-    if (endPos == string::npos) endPos = data.length();
-    
-    string value = data.substr(pos, endPos - pos);
-    // URL decode the value
-    string decoded;
-    for (size_t i = 0; i < value.length(); i++) {
-        if (value[i] == '%' && i + 2 < value.length()) {
-            string hex = value.substr(i + 1, 2);
-            char ch = static_cast<char>(stoi(hex, nullptr, 16));
-            decoded += ch;
-            i += 2;
-        } else if (value[i] == '+') {
-            decoded += ' ';
-        } else {
-            decoded += value[i];
-        }
-    }
-    return decoded;
-}
-
-string sanitizeInput(const string& input) {
-    string result;
-    for (char c : input) {
-        if (isalnum(c) || c == ',' || c == '-' || c == '_') {
-            result += c;
-        }
-    }
-    if (result.length() > MAX_CONTENT_LENGTH) {
-        throw runtime_error("Input too long");
-    }
-    return result;
-}
+using namespace std;
 
 int main() {
     try {
@@ -86,22 +22,26 @@ int main() {
         cout << "\r\n";
         
         // Capture POST data
-        string postData = getPostData();
+        char postData[FORM_BUFFER_SIZE];
+        size_t postLength = getPostData(postData);
         
         // More verbose logging
         cerr << "Received POST data: [" << postData << "]" << endl;
-        cerr << "Post data length: " << postData.length() << endl;
+        cerr << "Post data length: " << postLength << endl;
 
         // Initialize variables with detailed logging
         int fromRow = -1, fromCol = -1, toRow = -1, toCol = -1;
-        string boardState;
+        char boardState[FORM_BUFFER_SIZE];
+        size_t boardStateLength = 0;
 
         try {
             // Parse the move coordinates with more detailed error handling
-            string fromRowStr = getFormValue(postData, "fromRow");
-            string fromColStr = getFormValue(postData, "fromCol");
-            string toRowStr = getFormValue(postData, "toRow");
-            string toColStr = getFormValue(postData, "toCol");
+            char fromRowStr[FORM_BUFFER_SIZE], fromColStr[FORM_BUFFER_SIZE];
+            char toRowStr[FORM_BUFFER_SIZE], toColStr[FORM_BUFFER_SIZE];
+            bool hasFromRow = getFormValue(postData, "fromRow", fromRowStr) > 0;
+            bool hasFromCol = getFormValue(postData, "fromCol", fromColStr) > 0;
+            bool hasToRow = getFormValue(postData, "toRow", toRowStr) > 0;
+            bool hasToCol = getFormValue(postData, "toCol", toColStr) > 0;
             
             // Detailed logging added back
             cerr << "fromRow: " << fromRowStr << endl;
@@ -109,14 +49,19 @@ int main() {
             cerr << "toRow: " << toRowStr << endl;
             cerr << "toCol: " << toColStr << endl;
 
-            boardState = sanitizeInput(getFormValue(postData, "boardAsString"));
+            boardStateLength = sanitizeInput(boardState, getFormValue(postData, "boardAsString", boardState));
             cerr << "boardState: " << boardState << endl;
+
+            // Checked as the event server checks it, so a move is never
+            // published under an id the server would drop
+            char gameId[FORM_BUFFER_SIZE];
+            if (!validGameId(gameId, getFormValue(postData, "gameId", gameId))) strcpy(gameId, DEFAULT_GAME_ID);
 	
             // Convert to integers if values exist
-            if (!fromRowStr.empty()) fromRow = stoi(fromRowStr) - 1;
-            if (!fromColStr.empty()) fromCol = stoi(fromColStr);
-            if (!toRowStr.empty()) toRow = stoi(toRowStr) - 1;
-            if (!toColStr.empty()) toCol = stoi(toColStr);
+            if (hasFromRow) fromRow = formInt(fromRowStr) - 1;
+            if (hasFromCol) fromCol = formInt(fromColStr);
+            if (hasToRow) toRow = formInt(toRowStr) - 1;
+            if (hasToCol) toCol = formInt(toColStr);
 
             // More detailed validation logging
             cerr << "Parsed coordinates - fromRow: " << fromRow 
@@ -133,8 +78,8 @@ int main() {
             }
 
             Board gameBoard;
-            if (!boardState.empty()) {
-                gameBoard.stringToBoard(boardState);
+            if (boardStateLength > 0) {
+                gameBoard.stringToBoard(boardState, boardStateLength);
                 
                 // Detailed move validation logging
                 bool isValidMove = gameBoard.valid_move(fromRow, fromCol, toRow, toCol);
@@ -142,6 +87,12 @@ int main() {
                 
                 if (isValidMove) {
                     gameBoard.updateBoard(fromRow, fromCol, toRow, toCol);
+
+                    // Push the committed move to anyone watching this game
+                    MoveEvent event = makeMoveEvent(gameId, gameBoard, fromRow, fromCol, toRow, toCol);
+                    if (!publishMoveEvent(event)) {
+                        cerr << "Move event not delivered to " << eventSocketPath() << endl;
+                    }
                 } else {
                     throw runtime_error("Invalid move");
                 }
@@ -164,5 +115,9 @@ int main() {
         cout << "<input type='hidden' id='currentBoardState' value=''>";
     }
 
+#ifdef COUNT_ALLOCATIONS
+    // Read by loadtest, which reports heap allocations per request
+    cout << "<!-- allocations: " << allocationCount() << " -->\n";
+#endif
     return 0;
 }